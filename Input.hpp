@@ -4,22 +4,38 @@
 #include <memory>
 #include <stdexcept>
 
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INPUT_USE_MMAP 1
+#else
+#define INPUT_USE_MMAP 0
+#endif
+
 struct Input {
-    explicit Input(const char* filename) : m_file(std::fopen(filename, "rb")) {
-        if (!m_file) {
-            std::string msg("cannot open input ");
-            msg.append(filename);
-            throw std::runtime_error(msg);
-        }
-        std::fseek(m_file, 0, SEEK_END);
-        const auto size = std::ftell(m_file);
-        std::fseek(m_file, 0, SEEK_SET);
-        m_data = ::operator new(size);
-        m_size = std::fread(m_data, 1, size, m_file);
+    // Hint for how the content will be consumed once mapped.
+    enum class Access { Sequential, Random };
+
+    explicit Input(const char* filename, Access access = Access::Sequential) {
+#if INPUT_USE_MMAP
+        if (map(filename, access))
+            return;
+#endif
+        read(filename);
     }
 
+    Input(const Input&) = delete;
+    Input& operator=(const Input&) = delete;
+
     ~Input() {
-        std::fclose(m_file);
+#if INPUT_USE_MMAP
+        if (m_mapped) {
+            ::munmap(m_data, m_size);
+            return;
+        }
+#endif
         ::operator delete(m_data);
     }
 
@@ -27,8 +43,51 @@ struct Input {
 
     const void* data() const { return m_data; }
 
+    bool isMapped() const { return m_mapped; }
+
 private:
-    std::FILE* m_file;
-    void* m_data;
-    std::size_t m_size;
-};
\ No newline at end of file
+#if INPUT_USE_MMAP
+    bool map(const char* filename, Access access) {
+        const int fd = ::open(filename, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            p = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        m_data = p;
+        m_size = std::size_t(st.st_size);
+        m_mapped = true;
+        // Random access still touches the whole file, so fault it in ahead
+        // instead of disabling read-ahead.
+        ::madvise(p, m_size,
+                  access == Access::Sequential ? MADV_SEQUENTIAL
+                                               : MADV_WILLNEED);
+        return true;
+    }
+#endif
+
+    void read(const char* filename) {
+        const auto file = std::fopen(filename, "rb");
+        if (!file) {
+            std::string msg("cannot open input ");
+            msg.append(filename);
+            throw std::runtime_error(msg);
+        }
+        std::fseek(file, 0, SEEK_END);
+        const auto size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        m_data = ::operator new(size);
+        m_size = std::fread(m_data, 1, size, file);
+        std::fclose(file);
+    }
+
+    void* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+};
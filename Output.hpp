@@ -1,28 +1,60 @@
 #pragma once
 
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <format>
+#include <iterator>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 struct Output {
-    explicit Output(const char* filename) : m_file(std::fopen(filename, "wb")) {
-        if (!m_file) {
-            std::string msg("cannot open output ");
-            msg.append(filename);
-            throw std::runtime_error(msg);
+    enum class Write {
+        Always,
+        // Keep everything in memory and only replace the file in close() if
+        // the content differs, so its timestamp doesn't change needlessly.
+        IfChanged
+    };
+
+    // Collects everything written in memory, see str().
+    Output() = default;
+
+    explicit Output(const char* filename, Write write = Write::Always) {
+        if (write == Write::IfChanged) {
+            m_filename = filename;
+            return;
         }
+        m_file = open(filename);
+        m_str.reserve(flushSize);
     }
 
-    ~Output() { std::fclose(m_file); }
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
 
-    void write(const void* data, std::size_t bytes) {
-        std::fwrite(data, 1, bytes, m_file);
+    // With Write::IfChanged, nothing is written unless close() is called.
+    ~Output() {
+        if (m_file) {
+            flush();
+            std::fclose(m_file);
+        }
     }
 
-    void seek(unsigned offset) { std::fseek(m_file, offset, SEEK_SET); }
+    void write(const void* data, std::size_t bytes) {
+        if (bytes >= flushSize && m_file) {
+            flush();
+            std::fwrite(data, 1, bytes, m_file);
+            return;
+        }
+        m_str.append(static_cast<const char*>(data), bytes);
+        if (m_str.size() >= flushSize && m_file)
+            flush();
+    }
 
     Output& operator<<(char c) {
-        write(&c, 1);
+        m_str.push_back(c);
+        if (m_str.size() >= flushSize && m_file)
+            flush();
         return *this;
     }
 
@@ -31,8 +63,119 @@ struct Output {
         return *this;
     }
 
+    // Formats straight into the buffer, without a temporary string.
+    template<class... T>
+    void format(std::format_string<T...> fmt, T&&... arg) {
+        std::format_to(std::back_inserter(m_str), fmt,
+                       std::forward<T>(arg)...);
+        if (m_str.size() >= flushSize && m_file)
+            flush();
+    }
+
+    // Writes out the pending content and closes the file, reporting any
+    // failure that the destructor would have to ignore. Does nothing once
+    // closed.
+    void close() {
+        if (!m_filename.empty()) {
+            const auto filename = std::exchange(m_filename, {});
+            if (isSame(filename.c_str(), m_str))
+                return;
+            // Replace the file in one step, so readers never see it partially
+            // written, and don't leave the temporary file behind on failure.
+            const auto tmpFilename = filename + ".tmp";
+            try {
+                m_file = open(tmpFilename.c_str());
+                closeFile();
+                std::filesystem::rename(tmpFilename, filename);
+            } catch (...) {
+                std::error_code ec;
+                std::filesystem::remove(tmpFilename, ec);
+                throw;
+            }
+            return;
+        }
+        if (m_file)
+            closeFile();
+    }
+
+    std::string& str() { return m_str; }
+
 private:
-    std::FILE* m_file;
+    // Can be defined as 0 to pass every write straight to stdio, as before
+    // Output buffered them, for comparing in vklite_bench_generators.
+#ifdef OUTPUT_FLUSH_SIZE
+    static constexpr std::size_t flushSize = OUTPUT_FLUSH_SIZE;
+#else
+    static constexpr std::size_t flushSize = 1u << 20u;
+#endif
+
+    static std::FILE* open(const char* filename) {
+        const auto file = std::fopen(filename, "wb");
+        if (!file) {
+            std::string msg("cannot open output ");
+            msg.append(filename);
+            throw std::runtime_error(msg);
+        }
+        // Writes are already coalesced in m_str.
+        if (flushSize)
+            std::setvbuf(file, nullptr, _IONBF, 0);
+        return file;
+    }
+
+    static bool isSame(const char* filename, std::string_view content) {
+        const auto file = std::fopen(filename, "rb");
+        if (!file)
+            return false;
+        char buf[1u << 16u];
+        bool same = true;
+        while (same) {
+            const auto n = std::fread(buf, 1, sizeof(buf), file);
+            if (n == 0) {
+                same = content.empty() && !std::ferror(file);
+                break;
+            }
+            same = n <= content.size() &&
+                   std::memcmp(buf, content.data(), n) == 0;
+            content.remove_prefix(same ? n : 0);
+        }
+        std::fclose(file);
+        return same;
+    }
+
+    void flush() {
+        std::fwrite(m_str.data(), 1, m_str.size(), m_file);
+        m_str.clear();
+    }
+
+    void closeFile() {
+        flush();
+        const bool failed = std::ferror(m_file);
+        const auto file = std::exchange(m_file, nullptr);
+        if (std::fclose(file) != 0 || failed)
+            throw std::runtime_error("cannot write output");
+    }
+
+    std::FILE* m_file = nullptr;
+    // The file to replace in close() with Write::IfChanged.
+    std::string m_filename;
+    std::string m_str;
+};
+
+// An output iterator writing characters to a FILE, for formatting straight
+// into its buffer.
+struct FileIterator {
+    using difference_type = std::ptrdiff_t;
+
+    FileIterator& operator*() { return *this; }
+    FileIterator& operator++() { return *this; }
+    FileIterator operator++(int) { return *this; }
+
+    FileIterator& operator=(char c) {
+        std::fputc(c, file);
+        return *this;
+    }
+
+    std::FILE* file;
 };
 
 inline void print(std::string_view str) {
@@ -40,7 +183,6 @@ inline void print(std::string_view str) {
 }
 
 template<class... T>
-inline void print(std::string_view str, const T&... arg) {
-    const auto s = std::vformat(str, std::make_format_args(arg...));
-    std::fwrite(s.data(), 1, s.size(), stdout);
+inline void print(std::format_string<T...> fmt, T&&... arg) {
+    std::format_to(FileIterator{stdout}, fmt, std::forward<T>(arg)...);
 }
@@ -2,6 +2,9 @@
 
 #include <memory>
 #include <iterator>
+#include <algorithm>
+#include <span>
+#include <vector>
 
 template<class I, class Out>
 void eytzingerImpl(I n, Out& out, I k) {
@@ -76,3 +79,50 @@ auto topologicalSort(R&& range, F edge) {
     return topologicalSortImpl(std::ranges::begin(range), n, in_degree.get(),
                                edge);
 }
+
+template<class Adj, class Out>
+struct SccState {
+    Adj& adj;
+    Out& out;
+    std::vector<std::size_t> index;
+    std::vector<std::size_t> lowLink;
+    std::vector<std::size_t> stack;
+    std::vector<bool> onStack;
+    std::size_t next = 0;
+
+    void visit(std::size_t v) {
+        index[v] = lowLink[v] = ++next;
+        stack.push_back(v);
+        onStack[v] = true;
+        for (const std::size_t w : adj(v)) {
+            if (!index[w]) {
+                visit(w);
+                lowLink[v] = std::min(lowLink[v], lowLink[w]);
+            } else if (onStack[w]) {
+                lowLink[v] = std::min(lowLink[v], index[w]);
+            }
+        }
+        if (lowLink[v] == index[v]) {
+            const auto first = std::ranges::find(stack, v);
+            for (auto it = first; it != stack.end(); ++it)
+                onStack[*it] = false;
+            out(std::span<const std::size_t>(first, stack.end()));
+            stack.erase(first, stack.end());
+        }
+    }
+};
+
+// Tarjan's algorithm, `adj(v)` gives the vertices reachable from `v` in one
+// step. Calls `out` with each strongly connected component, after the ones
+// reachable from it.
+template<class Adj, class Out>
+void stronglyConnectedComponents(std::size_t n, Adj adj, Out out) {
+    SccState<Adj, Out> state{adj, out};
+    state.index.resize(n);
+    state.lowLink.resize(n);
+    state.onStack.resize(n);
+    for (std::size_t v = 0; v != n; ++v) {
+        if (!state.index[v])
+            state.visit(v);
+    }
+}
@@ -1,5 +1,12 @@
 #include <span>
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <utility>
 #include <boost/unordered/unordered_flat_set.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
 #include "XmlBin.hpp"
@@ -10,6 +17,17 @@
 using namespace xmlbin;
 
 struct XmlContext : Context {
+    // Checks the header, section table and every cross reference so that
+    // the accessors below never leave the buffer. Throws on a truncated,
+    // corrupted or stale file.
+    static const XmlContext& load(const void* data, std::size_t size) {
+        if (size < sizeof(XmlContext))
+            fail("file is truncated");
+        const auto& ctx = *static_cast<const XmlContext*>(data);
+        ctx.verify(size);
+        return ctx;
+    }
+
     template<class T>
     const T* data(ByteOffset offset) const {
         return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) +
@@ -20,6 +38,11 @@ struct XmlContext : Context {
         return data<char>(strings.offset) + idx.value;
     }
 
+    // Whether every occurrence of a string like `str` shares one StrId.
+    bool isInterned(std::string_view str) const {
+        return str.size() < header.dedupLength;
+    }
+
     std::string_view getOr(StrId idx, std::string_view other) const {
         return idx ? get(idx) : other;
     }
@@ -51,7 +74,7 @@ struct XmlContext : Context {
     StrId getUniqueStr(std::string_view str) const {
         Index k = 1;
         const auto t = data<StrId>(uniqueStrings.offset);
-        while (k <= uniqueStrings.count) {
+        while (k < uniqueStrings.count) {
             const auto idx = t[k];
             const auto cmp = get(idx) <=> str;
             if (cmp == std::strong_ordering::equal)
@@ -60,6 +83,74 @@ struct XmlContext : Context {
         }
         return {};
     }
+
+private:
+    [[noreturn]] static void fail(const char* reason) {
+        std::string msg("invalid xmlbin: ");
+        msg.append(reason);
+        throw std::runtime_error(msg);
+    }
+
+    template<class T>
+    bool fits(Segment seg, std::size_t size) const {
+        return seg.offset >= sizeof(XmlContext) &&
+               seg.offset % alignof(T) == 0 &&
+               seg.offset + std::uint64_t(seg.count) * sizeof(T) <= size;
+    }
+
+    template<class T>
+    bool fits(Sequence<T> seq, const Segment& seg) const {
+        return std::uint64_t(seq.start.value) + seq.count <= seg.count;
+    }
+
+    bool fits(StrId idx) const { return idx.value < strings.count; }
+
+    void verify(std::size_t size) const {
+        constexpr auto swappedMagic = ((kMagic & 0xffu) << 24u) |
+                                      ((kMagic & 0xff00u) << 8u) |
+                                      ((kMagic >> 8u) & 0xff00u) |
+                                      (kMagic >> 24u);
+        if (header.magic != kMagic)
+            fail(header.magic == swappedMagic ? "byte order mismatch"
+                                              : "bad magic");
+        if (header.version != kVersion)
+            fail("version mismatch");
+        if (header.size != size)
+            fail("size mismatch");
+        const auto base = reinterpret_cast<const char*>(this);
+        if (header.checksum !=
+            crc32c(base + sizeof(Header), size - sizeof(Header)))
+            fail("checksum mismatch");
+        if (!fits<char>(strings, size) || !fits<StrId>(uniqueStrings, size) ||
+            !fits<NodeId>(nodes, size) || !fits<Attribute>(attrs, size) ||
+            !fits<Element>(elems, size))
+            fail("section out of bounds");
+        if (!strings.count || data<char>(strings.offset)[strings.count - 1] ||
+            !uniqueStrings.count || !elems.count)
+            fail("empty section");
+        for (const auto idx : getUniqueStrList()) {
+            if (!fits(idx))
+                fail("bad string reference");
+        }
+        for (const auto& attr : std::span(data<Attribute>(attrs.offset),
+                                          attrs.count)) {
+            if (!fits(attr.name) || !fits(attr.value))
+                fail("bad string reference");
+        }
+        for (const auto node : std::span(data<NodeId>(nodes.offset),
+                                         nodes.count)) {
+            if (node.getKind() == NodeKind::Text
+                    ? !fits(StrId{node.getIndex()})
+                    : node.getIndex() >= elems.count)
+                fail("bad node reference");
+        }
+        for (const auto& elem : std::span(data<Element>(elems.offset),
+                                          elems.count)) {
+            if (!fits(elem.tag) || !fits(elem.attrs, attrs) ||
+                !fits(elem.children, nodes))
+                fail("bad element");
+        }
+    }
 };
 
 StrId findAttr(std::span<const Attribute> attrList, StrId nameId) {
@@ -176,6 +267,8 @@ struct Builder {
     struct EnumExtendInfo {
         const Element& m_elem;
         GuardId m_guard;
+        // The number of the extension it's required by, if any.
+        std::string_view m_extNumber;
     };
 
     struct CommandInfo {
@@ -188,7 +281,38 @@ struct Builder {
         const Element& m_elem;
     };
 
+    // A constant compared against attribute values and texts, by StrId when
+    // the xmlbin was written with deduplication.
+    struct ValueStr {
+        std::string_view m_str;
+        StrId m_id;
+        bool m_interned = false;
+    };
+
     const XmlContext& m_ctx;
+    // Also generate function pointer tables and handles calling through them.
+    bool m_dispatch = false;
+    // Make handle methods templates on the dispatcher they call through.
+    bool m_dispatchPolicy = false;
+    // Also generate overloads running two-call enumerations into a container.
+    bool m_enumerate = false;
+    // Also generate overloads taking spans for count and pointer pairs.
+    bool m_spans = false;
+    // Also generate the HandleTraits that unique.hpp destroys handles with.
+    bool m_unique = false;
+    // Also generate structureTypeOf and a perfect hash of the sType values.
+    bool m_chainLookup = false;
+    // Also generate the Reflection of every struct.
+    bool m_reflection = false;
+    // Also generate the EnumText of every enum, for toString.
+    bool m_toString = false;
+    // Also generate the EnumText of every enum with a perfect hash of the
+    // names, for parse.
+    bool m_parse = false;
+    // Generate commands that record their calls, see trace.hpp.
+    bool m_trace = false;
+    // Export the namespace when included by the module, see generateModule.
+    bool m_module = false;
     boost::unordered_flat_set<std::pair<std::string_view, std::string_view>>
         m_typeDeps;
     std::vector<TypeId> m_typeIds;
@@ -209,6 +333,8 @@ struct Builder {
     boost::unordered_flat_map<std::string_view, const Element*>
         m_internalFeatureMap;
     std::vector<CommandInfo> m_globalCommands;
+    // Every command in registry order, aliases included.
+    std::vector<std::string_view> m_commandNames;
     std::vector<TypeInfo> m_typeInfos;
     std::vector<DefInfo> m_defInfo;
     std::vector<BitmaskInfo> m_bitmaskInfo;
@@ -247,6 +373,7 @@ struct Builder {
     const StrId protoTag = m_ctx.getUniqueStr("proto");
     const StrId paramTag = m_ctx.getUniqueStr("param");
     const StrId lenTag = m_ctx.getUniqueStr("len");
+    const StrId altlenTag = m_ctx.getUniqueStr("altlen");
     const StrId apiTag = m_ctx.getUniqueStr("api");
     const StrId apitypeTag = m_ctx.getUniqueStr("apitype");
     const StrId supportedTag = m_ctx.getUniqueStr("supported");
@@ -255,12 +382,49 @@ struct Builder {
     const StrId removeTag = m_ctx.getUniqueStr("remove");
     const StrId objtypeenumTag = m_ctx.getUniqueStr("objtypeenum");
     const StrId provisionalTag = m_ctx.getUniqueStr("provisional");
+    const StrId valueTag = m_ctx.getUniqueStr("value");
+    const StrId offsetTag = m_ctx.getUniqueStr("offset");
+    const StrId extnumberTag = m_ctx.getUniqueStr("extnumber");
+    const StrId dirTag = m_ctx.getUniqueStr("dir");
+    const StrId bitposTag = m_ctx.getUniqueStr("bitpos");
+
+    const ValueStr structValue = getValueStr("struct");
+    const ValueStr handleValue = getValueStr("handle");
+    const ValueStr basetypeValue = getValueStr("basetype");
+    const ValueStr unionValue = getValueStr("union");
+    const ValueStr enumValue = getValueStr("enum");
+    const ValueStr bitmaskValue = getValueStr("bitmask");
+    const ValueStr internalValue = getValueStr("internal");
+    const ValueStr trueValue = getValueStr("true");
+    const ValueStr pNextValue = getValueStr("pNext");
+    const ValueStr matrixValue = getValueStr("matrix");
+    const ValueStr ppGeometriesValue = getValueStr("ppGeometries");
+    const ValueStr ppUsageCountsValue = getValueStr("ppUsageCounts");
+
+    ValueStr getValueStr(std::string_view str) const {
+        if (m_ctx.isInterned(str))
+            return {str, m_ctx.getUniqueStr(str), true};
+        return {str};
+    }
+
+    bool isValue(StrId id, const ValueStr& value) const {
+        if (value.m_interned)
+            return bool(id) && id == value.m_id;
+        return m_ctx.get(id) == value.m_str;
+    }
 
     struct GenState {
         bool m_delim = false;
         GuardId m_guard;
     };
 
+    struct TypeEntry {
+        TypeId m_typeId;
+        GuardId m_guard;
+        bool m_newKind = false;
+        bool m_spaced = false;
+    };
+
     void addSupport(std::string_view name, StrId guard) {
         const auto [it, inserted] =
             m_supported.emplace(name, GuardId{guard.value, false});
@@ -291,7 +455,7 @@ struct Builder {
                            : m_ctx.get(StrId{guard.value});
     }
 
-    GuardId updateGuard(Output& os, GuardId guard, GenState& state) {
+    GuardId updateGuard(Output& os, GuardId guard, GenState& state) const {
         if (guard == state.m_guard)
             return {};
         if (state.m_guard)
@@ -300,44 +464,1287 @@ struct Builder {
         return guard;
     }
 
-    void generateGuard(Output& os, GuardId guard) {
+    void generateGuard(Output& os, GuardId guard) const {
         if (guard)
             os << "#if " << getGuardStr(guard) << '\n';
     }
 
-    void generate(Output& os) {
+    void generate(Output& os, unsigned jobs = 1) const {
+        os << "#ifndef VKLITE_VULKAN_HPP\n"
+              "#define VKLITE_VULKAN_HPP\n"
+              "\n"
+              "#include \"core.hpp\"\n";
+        if (m_parse)
+            os << "#include \"parse.hpp\"\n";
+        if (m_trace)
+            generateCommandIds(os, "trace.hpp");
+        os << '\n';
+        generateNamespaceBegin(os);
+        const auto entries = prepareTypes();
+        std::vector<std::string> bodies;
+        if (jobs > 1)
+            bodies = renderTypes(entries, jobs);
+        GenState state;
+        for (std::size_t i = 0; i != entries.size(); ++i) {
+            const auto& entry = entries[i];
+            if (entry.m_newKind)
+                state.m_delim = true;
+            generateEntry(os, entry, bodies.empty() ? nullptr : &bodies[i],
+                          state);
+        }
+        generateGlobalCommands(os, state);
+        if (m_dispatch)
+            generateDispatch(os, entries);
+        if (m_dispatchPolicy)
+            generateGlobalDispatch(os, entries);
+        if (m_unique)
+            generateHandleTraits(os, entries);
+        if (m_reflection)
+            generateReflection(os, entries);
+        if (m_chainLookup)
+            generateChainLookup(os, entries);
+        os << "}\n"
+              "\n"
+              "#endif // VKLITE_VULKAN_HPP";
+    }
+
+    // Writes one header per guard into `dir`, and makes `os` an umbrella
+    // header that includes all of them, followed by what needs every type.
+    //
+    // Every header includes handles.hpp, which declares all the types and
+    // defines the handles with only the declarations of their methods. The
+    // header of a guard defines its types and the methods and global
+    // commands it adds, so that code using one feature only parses that
+    // one. Guards whose types depend on each other share one header, the
+    // headers of the others just include it. Headers of guards that no
+    // longer exist are removed.
+    void generateSplit(Output& os, const std::filesystem::path& dir,
+                       unsigned jobs, Output::Write write) const {
+        const auto entries = prepareTypes();
+        std::vector<std::string> bodies;
+        if (jobs > 1)
+            bodies = renderTypes(entries, jobs);
+
+        // The handles and ObjectType, which they're defined with, go into
+        // handles.hpp.
+        const auto isDeclared = [&](std::size_t i) {
+            const auto typeId = entries[i].m_typeId;
+            return typeId.getKind() == TypeKind::Handle ||
+                   getTypeName(typeId) == "ObjectType";
+        };
+        boost::unordered_flat_map<std::string_view, std::size_t> entryMap;
+        for (std::size_t i = 0; i != entries.size(); ++i)
+            entryMap.emplace(getTypeName(entries[i].m_typeId), i);
+        std::vector<std::pair<std::size_t, std::size_t>> deps;
+        const auto addDep = [&](std::string_view from, std::string_view to) {
+            const auto fromIt = entryMap.find(from);
+            const auto toIt = entryMap.find(to);
+            if (fromIt != entryMap.end() && toIt != entryMap.end() &&
+                !isDeclared(fromIt->second) && !isDeclared(toIt->second))
+                deps.emplace_back(fromIt->second, toIt->second);
+        };
+        for (const auto& [from, to] : m_typeDeps)
+            addDep(from, to);
+        for (const auto& bitmaskInfo : m_bitmaskInfo)
+            addDep(bitmaskInfo.m_type, bitmaskInfo.m_name);
+        std::ranges::sort(deps);
+
+        std::vector<std::string_view> guardStrs;
+        boost::unordered_flat_map<std::string_view, std::size_t> guardMap;
+        std::vector<std::vector<std::size_t>> includes;
+        const auto getGuard = [&](std::string_view str) {
+            const auto [it, inserted] =
+                guardMap.emplace(str, guardStrs.size());
+            if (inserted) {
+                guardStrs.push_back(str);
+                includes.emplace_back();
+            }
+            return it->second;
+        };
+        // What's required by several guards belongs to each of them.
+        const auto addGuard = [&](GuardId guard) {
+            const auto str = getGuardStr(guard);
+            const auto g = getGuard(str);
+            if (guard.multi) {
+                constexpr std::string_view sep = " || ";
+                for (auto rest = str;;) {
+                    const auto pos = rest.find(sep);
+                    includes[getGuard(rest.substr(0, pos))].push_back(g);
+                    if (pos == std::string_view::npos)
+                        break;
+                    rest.remove_prefix(pos + sep.size());
+                }
+            }
+            return g;
+        };
+        std::vector<std::size_t> entryGuards(entries.size());
+        for (std::size_t i = 0; i != entries.size(); ++i) {
+            if (!isDeclared(i))
+                entryGuards[i] = addGuard(entries[i].m_guard);
+        }
+        for (const auto& [from, to] : deps) {
+            if (entryGuards[from] != entryGuards[to])
+                includes[entryGuards[to]].push_back(entryGuards[from]);
+        }
+
+        // The commands are defined with the guard that adds them, after the
+        // types they take.
+        struct SplitCommand {
+            const CommandInfo* m_cmd;
+            std::size_t m_handle;
+            std::size_t m_guard;
+        };
+        std::vector<SplitCommand> commands;
+        const auto addCommand = [&](const CommandInfo& cmd,
+                                    std::size_t handle) {
+            auto name = m_ctx.get(cmd.m_name);
+            if (!consumeMatch(name, "vk"))
+                return;
+            const auto support = findSupport(name);
+            if (!support)
+                return;
+            const auto g = addGuard(*support);
+            commands.push_back({&cmd, handle, g});
+            for (const auto child : m_ctx.getList(cmd.m_elem.children)) {
+                if (child.getKind() != NodeKind::Element)
+                    continue;
+                const auto& elem = m_ctx.get(Idx<Element>{child.getIndex()});
+                auto type = m_ctx.get(getChildElemText(elem, typeTag));
+                if (!consumeMatch(type, "Vk"))
+                    continue;
+                const auto it = entryMap.find(type);
+                if (it != entryMap.end() && !isDeclared(it->second) &&
+                    entryGuards[it->second] != g)
+                    includes[g].push_back(entryGuards[it->second]);
+            }
+        };
+        for (std::size_t i = 0; i != entries.size(); ++i) {
+            if (entries[i].m_typeId.getKind() != TypeKind::Handle)
+                continue;
+            const auto typeName = getTypeName(entries[i].m_typeId);
+            for (const auto& cmd : findCommands(typeName))
+                addCommand(cmd, i);
+        }
+        for (const auto& cmd : m_globalCommands)
+            addCommand(cmd, entries.size());
+
+        // The components come out with the headers they include first.
+        std::vector<std::vector<std::size_t>> headers;
+        std::vector<std::size_t> guardHeaders(guardStrs.size());
+        stronglyConnectedComponents(
+            guardStrs.size(),
+            [&](std::size_t g) -> const std::vector<std::size_t>& {
+                return includes[g];
+            },
+            [&](std::span<const std::size_t> component) {
+                for (const auto g : component)
+                    guardHeaders[g] = headers.size();
+                headers.emplace_back(component.begin(), component.end());
+                std::ranges::sort(headers.back());
+            });
+
+        std::filesystem::create_directories(dir);
+        const auto dirName = dir.filename().string();
+        const auto getFileName = [&](std::size_t h) {
+            return getSplitName(guardStrs[headers[h].front()]) + ".hpp";
+        };
+        constexpr std::string_view declName = "handles.hpp";
+        boost::unordered_flat_set<std::string> fileNames;
+        fileNames.emplace(declName);
+        {
+            const auto path = (dir / declName).string();
+            Output out{path.c_str(), write};
+            generateSplitBegin(out, declName, "../core.hpp");
+            if (m_parse)
+                out << "#include \"../parse.hpp\"\n";
+            if (m_trace)
+                generateCommandIds(out, "../trace.hpp");
+            out << '\n';
+            generateNamespaceBegin(out);
+            GenState state;
+            for (std::size_t i = 0; i != entries.size(); ++i) {
+                const auto& entry = entries[i];
+                const auto typeId = entry.m_typeId;
+                const auto typeName = getTypeName(typeId);
+                generateGuard(out, updateGuard(out, entry.m_guard, state));
+                switch (typeId.getKind()) {
+                case TypeKind::Struct:
+                case TypeKind::Handle:
+                    out << "struct " << typeName << ";\n";
+                    break;
+                case TypeKind::Enum:
+                    if (isDeclared(i)) {
+                        out << '\n';
+                        generateEnum(out, typeId);
+                        out << '\n';
+                    } else {
+                        out << "enum class " << typeName << " : "
+                            << getEnumValueType(
+                                   m_typeInfos[typeId.getIndex()])
+                            << ";\n";
+                    }
+                    break;
+                case TypeKind::Bitmask: {
+                    const auto& bitmaskInfo =
+                        m_bitmaskInfo[typeId.getIndex()];
+                    out << "using " << bitmaskInfo.m_name << " = ";
+                    if (isFlagSet(bitmaskInfo)) {
+                        out << "FlagSet<" << bitmaskInfo.m_enum << ", "
+                            << bitmaskInfo.m_type << ">;\n";
+                    } else {
+                        out << bitmaskInfo.m_type << ";\n";
+                    }
+                    break;
+                }
+                default: generateType(out, entry); break;
+                }
+            }
+            state.m_delim = true;
+            for (std::size_t i = 0; i != entries.size(); ++i) {
+                const auto& entry = entries[i];
+                if (entry.m_typeId.getKind() != TypeKind::Handle)
+                    continue;
+                const auto guard = updateGuard(out, entry.m_guard, state);
+                if (std::exchange(state.m_delim, false))
+                    out << '\n';
+                generateGuard(out, guard);
+                generateHandle(out, entry.m_typeId, entry.m_guard,
+                               MethodPart::Declaration);
+            }
+            updateGuard(out, {}, state);
+            out << "}\n";
+            generateSplitEnd(out, declName);
+            out.close();
+        }
+
+        for (std::size_t h = 0; h != headers.size(); ++h) {
+            const auto& guards = headers[h];
+            const auto fileName = getFileName(h);
+            std::vector<std::size_t> incs;
+            for (const auto g : guards) {
+                for (const auto inc : includes[g]) {
+                    if (guardHeaders[inc] != h)
+                        incs.push_back(guardHeaders[inc]);
+                }
+            }
+            std::ranges::sort(incs);
+            incs.erase(std::ranges::unique(incs).begin(), incs.end());
+            const auto path = (dir / fileName).string();
+            fileNames.insert(fileName);
+            Output out{path.c_str(), write};
+            generateSplitBegin(out, fileName, declName);
+            for (const auto inc : incs)
+                out << "#include \"" << getFileName(inc) << "\"\n";
+            GenState state;
+            bool open = false;
+            const auto begin = [&] {
+                if (!std::exchange(open, true)) {
+                    out << '\n';
+                    generateNamespaceBegin(out);
+                }
+            };
+            std::optional<TypeKind> lastKind;
+            for (std::size_t i = 0; i != entries.size(); ++i) {
+                const auto& entry = entries[i];
+                if (isDeclared(i) || guardHeaders[entryGuards[i]] != h)
+                    continue;
+                const auto kind = entry.m_typeId.getKind();
+                begin();
+                if (lastKind && lastKind != kind)
+                    state.m_delim = true;
+                lastKind = kind;
+                generateEntry(out, entry,
+                              bodies.empty() ? nullptr : &bodies[i], state);
+            }
+            // The methods, within the guard of their handle.
+            for (std::size_t c = 0; c != commands.size();) {
+                const auto handle = commands[c].m_handle;
+                auto end = c;
+                bool any = false;
+                for (; end != commands.size() &&
+                       commands[end].m_handle == handle;
+                     ++end)
+                    any |= guardHeaders[commands[end].m_guard] == h;
+                if (!any) {
+                    c = end;
+                    continue;
+                }
+                begin();
+                GuardId baseGuard;
+                std::string_view typeName;
+                if (handle != entries.size()) {
+                    baseGuard = entries[handle].m_guard;
+                    typeName = getTypeName(entries[handle].m_typeId);
+                    const auto guard = updateGuard(out, baseGuard, state);
+                    out << '\n';
+                    generateGuard(out, guard);
+                } else {
+                    updateGuard(out, {}, state);
+                    out << '\n';
+                }
+                const auto part = handle != entries.size()
+                                      ? MethodPart::Definition
+                                      : MethodPart::Inline;
+                GenState stateMethod;
+                for (; c != end; ++c) {
+                    if (guardHeaders[commands[c].m_guard] == h)
+                        generateCommand(out, *commands[c].m_cmd, typeName,
+                                        baseGuard, stateMethod, "vk", part);
+                }
+                updateGuard(out, {}, stateMethod);
+            }
+            if (open) {
+                updateGuard(out, {}, state);
+                out << "}\n";
+            }
+            generateSplitEnd(out, fileName);
+            out.close();
+            // The other guards of a shared header only refer to it.
+            for (const auto g : std::span(guards).subspan(1)) {
+                const auto stubName = getSplitName(guardStrs[g]) + ".hpp";
+                const auto stubPath = (dir / stubName).string();
+                fileNames.insert(stubName);
+                Output stub{stubPath.c_str(), write};
+                generateSplitBegin(stub, stubName, fileName);
+                generateSplitEnd(stub, stubName);
+                stub.close();
+            }
+        }
+
+        for (const auto& file : std::filesystem::directory_iterator(dir)) {
+            const auto& path = file.path();
+            if (file.is_regular_file() && path.extension() == ".hpp" &&
+                !fileNames.contains(path.filename().string()))
+                std::filesystem::remove(path);
+        }
+
         os << "#ifndef VKLITE_VULKAN_HPP\n"
               "#define VKLITE_VULKAN_HPP\n"
+              "\n";
+        for (std::size_t h = 0; h != headers.size(); ++h)
+            os << "#include \"" << dirName << '/' << getFileName(h) << "\"\n";
+        if (m_dispatch || m_dispatchPolicy || m_unique || m_reflection ||
+            m_chainLookup) {
+            os << '\n';
+            generateNamespaceBegin(os);
+            if (m_dispatch)
+                generateDispatch(os, entries);
+            if (m_dispatchPolicy)
+                generateGlobalDispatch(os, entries);
+            if (m_unique)
+                generateHandleTraits(os, entries);
+            if (m_reflection)
+                generateReflection(os, entries);
+            if (m_chainLookup)
+                generateChainLookup(os, entries);
+            os << "}\n";
+        }
+        os << "\n"
+              "#endif // VKLITE_VULKAN_HPP";
+    }
+
+    // A module interface unit exporting everything vulkan.hpp declares.
+    // The headers are included in its purview with VKLITE_EXPORT defined as
+    // export, in extern "C++" so that the entities stay attached to the
+    // global module, and code importing vklite and code including
+    // vulkan.hpp can be mixed. The standard headers they include must come
+    // first, in the global module fragment.
+    void generateModule(Output& os) const {
+        os << "module;\n"
               "\n"
-              "#include \"core.hpp\"\n"
+              "#ifdef VKLITE_VULKAN_API_HEADER\n"
+              "#include VKLITE_VULKAN_API_HEADER\n"
+              "#else\n"
+              "#include <vulkan/vulkan.h>\n"
+              "#endif\n";
+        static constexpr std::string_view stdHeaders[] = {
+            "algorithm",    "atomic",       "bit",
+            "cassert",      "chrono",       "cstddef",
+            "cstdlib",      "cstring",      "new",
+            "optional",     "span",         "string",
+            "string_view",  "system_error", "tuple",
+            "type_traits",  "utility",      "vector",
+        };
+        for (const auto header : stdHeaders)
+            os << "#include <" << header << ">\n";
+        os << "\n"
+              "export module vklite;\n"
+              "\n"
+              "#define VKLITE_EXPORT export\n"
+              "#define VKLITE_INSTANTIATE_PARSE(T) \\\n"
+              "  template std::optional<T> parse<T>(std::string_view) "
+              "noexcept;\n"
+              "extern \"C++\" {\n"
+              "#include \"vklite/vulkan.hpp\"\n"
+              "#include \"vklite/chain.hpp\"\n";
+        if (m_unique) {
+            os << "#include \"vklite/unique.hpp\"\n"
+                  "#include \"vklite/deferred.hpp\"\n";
+        }
+        if (m_reflection && m_chainLookup)
+            os << "#include \"vklite/hash.hpp\"\n";
+        os << "}";
+    }
+
+    // Whether the command is generated and returns a Result.
+    bool isChecked(const CommandInfo& cmd) const {
+        auto name = m_ctx.get(cmd.m_name);
+        if (!consumeMatch(name, "vk") || !findSupport(name))
+            return false;
+        const auto proto = m_ctx.getList(cmd.m_elem.children).begin();
+        const auto& protoElem = m_ctx.get(Idx<Element>{proto->getIndex()});
+        return m_ctx.get(getChildElemText(protoElem, typeTag)) == "VkResult";
+    }
+
+    // A source calling every handle method whose result is checked, each
+    // from its own function, for comparing the code of the failure paths.
+    void generateChecks(Output& os) const {
+        os << "#include <vulkan/vulkan.h>\n"
+              "#include <vklite/vulkan.hpp>\n"
               "\n"
-              "namespace vklite {\n";
+              "namespace vklite::checks {\n";
         GenState state;
+        for (const auto& entry : prepareTypes()) {
+            if (entry.m_typeId.getKind() != TypeKind::Handle)
+                continue;
+            const auto typeName = getTypeName(entry.m_typeId);
+            const auto commands = findCommands(typeName);
+            if (std::ranges::none_of(commands, [&](const CommandInfo& cmd) {
+                    return isChecked(cmd);
+                }))
+                continue;
+            generateGuard(os, updateGuard(os, entry.m_guard, state));
+            GenState stateMethod;
+            for (const auto& cmd : commands) {
+                generateCommand(os, cmd, typeName, entry.m_guard, stateMethod,
+                                "vk", MethodPart::Check);
+            }
+            updateGuard(os, {}, stateMethod);
+        }
+        updateGuard(os, {}, state);
+        os << "}\n";
+    }
+
+    // Exported when included by the module, see generateModule.
+    void generateNamespaceBegin(Output& os) const {
+        if (m_module)
+            os << "VKLITE_EXPORT ";
+        os << "namespace vklite {\n";
+    }
+
+    // "VK_VERSION_1_2 || VK_KHR_foo" becomes "VK_VERSION_1_2_or_VK_KHR_foo".
+    static std::string getSplitName(std::string_view guardStr) {
+        constexpr std::string_view sep = " || ";
+        std::string name;
+        for (;;) {
+            const auto pos = guardStr.find(sep);
+            name += guardStr.substr(0, pos);
+            if (pos == std::string_view::npos)
+                break;
+            name += "_or_";
+            guardStr.remove_prefix(pos + sep.size());
+        }
+        return name;
+    }
+
+    static std::string getSplitMacro(std::string_view fileName) {
+        std::string macro("VKLITE_");
+        for (const char c : fileName)
+            macro += c == '.' ? '_' : toCapital(c);
+        return macro;
+    }
+
+    // Generates CommandId, a dense index of the commands, and includes
+    // trace.hpp, which the commands record their calls with.
+    void generateCommandIds(Output& os, std::string_view traceHeader) const {
+        std::vector<std::string_view> names;
+        for (auto name : m_commandNames) {
+            if (consumeMatch(name, "vk") && findSupport(name))
+                names.push_back(name);
+        }
+        os << '\n';
+        generateNamespaceBegin(os);
+        os << "enum class CommandId : uint32_t {\n";
+        for (const auto name : names)
+            os << "  e" << name << ",\n";
+        os << "};\n"
+              "\n"
+              "inline constexpr std::string_view commandNames[] = {\n";
+        for (const auto name : names)
+            os << "  \"vk" << name << "\",\n";
+        os << "};\n"
+              "}\n"
+              "\n"
+              "#include \""
+           << traceHeader << "\"\n";
+    }
+
+    static void generateSplitBegin(Output& os, std::string_view fileName,
+                                   std::string_view include) {
+        const auto macro = getSplitMacro(fileName);
+        os << "#ifndef " << macro << "\n"
+           << "#define " << macro << "\n"
+              "\n"
+              "#include \""
+           << include << "\"\n";
+    }
+
+    static void generateSplitEnd(Output& os, std::string_view fileName) {
+        os << "\n"
+              "#endif // "
+           << getSplitMacro(fileName);
+    }
+
+    std::vector<TypeEntry> prepareTypes() const {
+        std::vector<TypeEntry> entries;
         auto lastKind = TypeKind::Raw;
+        bool newKind = false;
         for (const auto typeId : m_typeIds) {
             const auto kind = typeId.getKind();
             if (lastKind != kind) {
                 lastKind = kind;
-                state.m_delim = true;
+                newKind = true;
+            }
+            TypeEntry entry;
+            if (prepareType(typeId, entry)) {
+                entry.m_newKind = std::exchange(newKind, false);
+                entries.push_back(entry);
+            }
+        }
+        return entries;
+    }
+
+    // Writes the guard and separator before the type, then its body, either
+    // generated in place or already rendered.
+    void generateEntry(Output& os, const TypeEntry& entry,
+                       const std::string* body, GenState& state) const {
+        const auto guard = updateGuard(os, entry.m_guard, state);
+        if (entry.m_spaced) {
+            os << '\n';
+            state.m_delim = true;
+        } else if (state.m_delim) {
+            os << '\n';
+            state.m_delim = false;
+        }
+        generateGuard(os, guard);
+        if (body)
+            os << *body;
+        else
+            generateType(os, entry);
+    }
+
+    // Instance and physical device commands are resolved through the
+    // instance, the commands of all other handles through the device.
+    static bool isInstanceLevel(std::string_view handle) {
+        return handle == "Instance" || handle == "PhysicalDevice";
+    }
+
+    template<class Fn>
+    void forEachDispatchCommand(std::span<const TypeEntry> entries,
+                                bool instanceLevel, Fn fn) const {
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Handle)
+                continue;
+            const auto typeName = getTypeName(entry.m_typeId);
+            if (isInstanceLevel(typeName) != instanceLevel)
+                continue;
+            for (const auto& cmd : findCommands(typeName)) {
+                auto name = m_ctx.get(cmd.m_name);
+                if (!consumeMatch(name, "vk"))
+                    continue;
+                if (const auto support = findSupport(name))
+                    fn(name, *support);
+            }
+        }
+    }
+
+    void generateDispatchTable(Output& os, std::span<const TypeEntry> entries,
+                               bool instanceLevel) const {
+        const std::string_view table =
+            instanceLevel ? "InstanceDispatch" : "DeviceDispatch";
+        const std::string_view handle = instanceLevel ? "Instance" : "Device";
+        os << "\nstruct " << table << " {\n";
+        GenState state;
+        forEachDispatchCommand(
+            entries, instanceLevel, [&](std::string_view name, GuardId guard) {
+                generateGuard(os, updateGuard(os, guard, state));
+                os << "  PFN_vk" << name << " vk" << name << " = nullptr;\n";
+            });
+        updateGuard(os, {}, state);
+        os << "\n  void load(Vk" << handle << " handle, PFN_vkGet" << handle
+           << "ProcAddr getProcAddr) noexcept {\n";
+        forEachDispatchCommand(
+            entries, instanceLevel, [&](std::string_view name, GuardId guard) {
+                generateGuard(os, updateGuard(os, guard, state));
+                os << "    vk" << name << " = reinterpret_cast<PFN_vk" << name
+                   << ">(getProcAddr(handle, \"vk" << name << "\"));\n";
+            });
+        updateGuard(os, {}, state);
+        os << "  }\n"
+              "};\n";
+    }
+
+    // Tables of the commands loaded for one instance or device, and a
+    // variant of every handle with commands that calls through them instead
+    // of the global entry points.
+    void generateDispatch(Output& os,
+                          std::span<const TypeEntry> entries) const {
+        generateDispatchTable(os, entries, true);
+        generateDispatchTable(os, entries, false);
+        GenState state{.m_delim = true};
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Handle)
+                continue;
+            const auto typeName = getTypeName(entry.m_typeId);
+            const auto commands = findCommands(typeName);
+            if (commands.empty())
+                continue;
+            const auto guard = updateGuard(os, entry.m_guard, state);
+            if (state.m_delim) {
+                os << '\n';
+                state.m_delim = false;
+            }
+            generateGuard(os, guard);
+            os << "template<> struct Dispatched<" << typeName
+               << "> : " << typeName << " {\n"
+               << "  const "
+               << (isInstanceLevel(typeName) ? "InstanceDispatch"
+                                             : "DeviceDispatch")
+               << "* dispatch = nullptr;\n";
+            GenState stateMethod{.m_delim = true};
+            for (const auto& cmd : commands) {
+                generateCommand(os, cmd, typeName, entry.m_guard, stateMethod,
+                                "this->dispatch->vk");
+            }
+            updateGuard(os, {}, stateMethod);
+            os << "};\n";
+        }
+        updateGuard(os, {}, state);
+    }
+
+    // The default dispatcher of the handle methods, it refers to the global
+    // entry points, whether they're prototypes or loader pointers like volk's.
+    void generateGlobalDispatch(Output& os,
+                                std::span<const TypeEntry> entries) const {
+        os << "\nstruct GlobalDispatch {\n";
+        GenState state;
+        for (const bool instanceLevel : {true, false}) {
+            forEachDispatchCommand(
+                entries, instanceLevel,
+                [&](std::string_view name, GuardId guard) {
+                    generateGuard(os, updateGuard(os, guard, state));
+                    os << "  static constexpr auto& vk" << name << " = ::vk"
+                       << name << ";\n";
+                });
+        }
+        updateGuard(os, {}, state);
+        os << "};\n";
+    }
+
+    // The handle a vkDestroy* or vkFree* command destroys, if it takes
+    // nothing but its parent and an allocator, or the handle and an
+    // allocator if it destroys itself.
+    std::string_view getDestroyedHandle(const CommandInfo& cmd) const {
+        const auto name = m_ctx.get(cmd.m_name);
+        if (!name.starts_with("vkDestroy") && !name.starts_with("vkFree"))
+            return {};
+        std::vector<VarInfo> params;
+        processChildElems(cmd.m_elem, paramTag, [&](const Element& param) {
+            if (checkApi(m_ctx.getList(param.attrs)))
+                params.push_back(getVarInfo(param));
+        });
+        if (params.empty() || params.size() > 3 ||
+            params.back().m_name != "pAllocator")
+            return {};
+        auto handle = params[params.size() - 2].m_type;
+        if (!params[params.size() - 2].m_typeSuffix.empty() ||
+            !consumeMatch(handle, "Vk") || !m_handleCommands.contains(handle))
+            return {};
+        return handle;
+    }
+
+    // Generates HandleTraits for all handles with a destroy command.
+    void generateHandleTraits(Output& os,
+                              std::span<const TypeEntry> entries) const {
+        boost::unordered_flat_set<std::string_view> done;
+        GenState state{.m_delim = true};
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Handle)
+                continue;
+            const auto typeName = getTypeName(entry.m_typeId);
+            for (const auto& cmd : findCommands(typeName)) {
+                const auto handle = getDestroyedHandle(cmd);
+                if (handle.empty() || done.contains(handle))
+                    continue;
+                auto name = m_ctx.get(cmd.m_name);
+                consumeMatch(name, "vk");
+                const auto support = findSupport(name);
+                if (!support)
+                    continue;
+                done.insert(handle);
+                const auto guard =
+                    updateGuard(os, subGuard(entry.m_guard, *support), state);
+                if (state.m_delim) {
+                    os << '\n';
+                    state.m_delim = false;
+                }
+                generateGuard(os, guard);
+                const bool self = handle == typeName;
+                os << "template<> struct HandleTraits<" << handle << "> {\n"
+                   << "  using Parent = " << (self ? "NoParent" : typeName)
+                   << ";\n"
+                   << "  static void destroy(Parent" << (self ? "" : " parent")
+                   << ", " << handle << " handle) noexcept { ";
+                if (self)
+                    os << "handle.";
+                else
+                    os << "parent.";
+                generateFnName(os, typeName, name);
+                os << (self ? "()" : "(handle)") << "; }\n"
+                   << "};\n";
+            }
+        }
+        updateGuard(os, {}, state);
+    }
+
+    // The value of an enumerant, from either its value or its offset in the
+    // range of an extension.
+    std::optional<int64_t> getEnumValue(const Element& elem,
+                                        std::string_view extNumber) const {
+        const auto attrs = m_ctx.getList(elem.attrs);
+        const auto toInt = [](std::string_view str) -> std::optional<int64_t> {
+            const int base = consumeMatch(str, "0x") ? 16 : 10;
+            int64_t value;
+            const auto e = str.data() + str.size();
+            const auto [p, ec] = std::from_chars(str.data(), e, value, base);
+            if (ec != std::errc() || p != e)
+                return std::nullopt;
+            return value;
+        };
+        if (const auto valueAttr = findAttr(attrs, valueTag))
+            return toInt(m_ctx.get(valueAttr));
+        if (const auto bitposAttr = findAttr(attrs, bitposTag)) {
+            const auto bitpos = toInt(m_ctx.get(bitposAttr));
+            if (!bitpos || *bitpos < 0 || *bitpos > 63)
+                return std::nullopt;
+            return int64_t(uint64_t(1) << *bitpos);
+        }
+        const auto offsetAttr = findAttr(attrs, offsetTag);
+        if (!offsetAttr)
+            return std::nullopt;
+        if (const auto extnumberAttr = findAttr(attrs, extnumberTag))
+            extNumber = m_ctx.get(extnumberAttr);
+        const auto offset = toInt(m_ctx.get(offsetAttr));
+        const auto number = toInt(extNumber);
+        if (!offset || !number)
+            return std::nullopt;
+        const auto value = 1000000000 + (*number - 1) * 1000 + *offset;
+        if (const auto dirAttr = findAttr(attrs, dirTag)) {
+            if (m_ctx.get(dirAttr) == "-")
+                return -value;
+        }
+        return value;
+    }
+
+    // A perfect hash of 32-bit keys into 2^m_slotBits slots. The keys are
+    // spread over buckets, and each bucket has a seed that places its keys
+    // in free slots:
+    //   bucket = (key * 0x9e3779b1) >> (32 - m_bucketBits)
+    //   slot = ((key ^ m_seeds[bucket]) * 0x85ebca6b) >> (32 - m_slotBits)
+    // Empty slots hold a key of another slot, so that no lookup finds them.
+    struct PerfectHash {
+        unsigned m_bucketBits;
+        unsigned m_slotBits;
+        std::vector<uint32_t> m_seeds;
+        std::vector<uint32_t> m_keys;
+
+        uint32_t getSlot(uint32_t key) const {
+            const auto bucket = (key * 0x9e3779b1u) >> (32 - m_bucketBits);
+            return ((key ^ m_seeds[bucket]) * 0x85ebca6bu) >>
+                   (32 - m_slotBits);
+        }
+    };
+
+    static PerfectHash makePerfectHash(std::span<const uint32_t> keys) {
+        // 0x7fffffff marks the free slots while the seeds are searched.
+        if (std::ranges::find(keys, 0x7fffffffu) != keys.end())
+            throw std::runtime_error("0x7fffffff is no perfect hash key");
+        PerfectHash hash;
+        const auto slotCount = std::bit_ceil(keys.size() + keys.size() / 2 + 2);
+        hash.m_slotBits = unsigned(std::countr_zero(slotCount));
+        hash.m_bucketBits = std::max(hash.m_slotBits, 3u) - 2;
+        hash.m_seeds.resize(std::size_t(1) << hash.m_bucketBits);
+        hash.m_keys.resize(slotCount, 0x7fffffffu);
+        std::vector<std::vector<uint32_t>> buckets(hash.m_seeds.size());
+        for (const auto key : keys)
+            buckets[(key * 0x9e3779b1u) >> (32 - hash.m_bucketBits)]
+                .push_back(key);
+        std::vector<uint32_t> order(buckets.size());
+        for (uint32_t i = 0; i != order.size(); ++i)
+            order[i] = i;
+        std::ranges::stable_sort(order, [&](uint32_t a, uint32_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+        std::vector<uint32_t> slots;
+        for (const auto b : order) {
+            const auto& bucket = buckets[b];
+            uint32_t seed = 0;
+            for (;; ++seed) {
+                if (seed == 1u << 24u)
+                    throw std::runtime_error("cannot make a perfect hash");
+                slots.clear();
+                for (const auto key : bucket) {
+                    const auto slot =
+                        ((key ^ seed) * 0x85ebca6bu) >> (32 - hash.m_slotBits);
+                    if (hash.m_keys[slot] != 0x7fffffffu ||
+                        std::ranges::find(slots, slot) != slots.end())
+                        break;
+                    slots.push_back(slot);
+                }
+                if (slots.size() == bucket.size())
+                    break;
+            }
+            hash.m_seeds[b] = seed;
+            for (std::size_t i = 0; i != bucket.size(); ++i)
+                hash.m_keys[slots[i]] = bucket[i];
+        }
+        for (uint32_t slot = 0; slot != slotCount; ++slot) {
+            if (hash.m_keys[slot] != 0x7fffffffu)
+                continue;
+            uint32_t key = 0;
+            while (hash.getSlot(key) == slot)
+                ++key;
+            hash.m_keys[slot] = key;
+        }
+        return hash;
+    }
+
+    static void generateTable(Output& os, std::string_view name,
+                              std::span<const uint32_t> values) {
+        os << "inline constexpr uint32_t " << name << "[] = {";
+        for (std::size_t i = 0; i != values.size(); ++i) {
+            os << (i % 16 ? " " : "\n  ");
+            os.format("{},", values[i]);
+        }
+        os << "\n};\n";
+    }
+
+    // Generates structureTypeOf for every struct with an sType, and
+    // visitChain, which switches on a perfect hash of the sType values so
+    // that it compiles to a jump table.
+    void generateChainLookup(Output& os,
+                             std::span<const TypeEntry> entries) const {
+        boost::unordered_flat_map<std::string_view, int64_t> values;
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Enum ||
+                getTypeName(entry.m_typeId) != "StructureType")
+                continue;
+            const auto& typeInfo = m_typeInfos[entry.m_typeId.getIndex()];
+            const auto add = [&](const Element& elem,
+                                 std::string_view extNumber) {
+                const auto nameAttr =
+                    findAttr(m_ctx.getList(elem.attrs), nameTag);
+                if (!nameAttr)
+                    return;
+                if (const auto value = getEnumValue(elem, extNumber))
+                    values.insert({m_ctx.get(nameAttr), *value});
+            };
+            processChildElems(*typeInfo.m_elem, enumTag,
+                              [&](const Element& elem) { add(elem, {}); });
+            for (const auto& enumExtend : findEnumExtends(typeInfo.m_name))
+                add(enumExtend.m_elem, enumExtend.m_extNumber);
+        }
+        struct StructType {
+            const TypeEntry& m_entry;
+            std::string_view m_value;
+            uint32_t m_key;
+        };
+        std::vector<StructType> structTypes;
+        std::vector<uint32_t> keys;
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Struct)
+                continue;
+            const auto& typeInfo = m_typeInfos[entry.m_typeId.getIndex()];
+            processChildElems(
+                *typeInfo.m_elem, memberTag, [&](const Element& elem) {
+                    const auto nameTxt = getChildElemText(elem, nameTag);
+                    if (!nameTxt || m_ctx.get(nameTxt) != "sType")
+                        return;
+                    const auto valuesAttr =
+                        findAttr(m_ctx.getList(elem.attrs), valuesTag);
+                    if (!valuesAttr)
+                        return;
+                    const auto value = m_ctx.get(valuesAttr);
+                    const auto it = values.find(value);
+                    if (it == values.end())
+                        return;
+                    const auto key = uint32_t(it->second);
+                    if (std::ranges::find(keys, key) != keys.end())
+                        return;
+                    keys.push_back(key);
+                    structTypes.push_back({entry, value, key});
+                });
+        }
+        const auto hash = makePerfectHash(keys);
+        os << '\n';
+        GenState state;
+        for (const auto& structType : structTypes) {
+            const auto guard = structType.m_entry.m_guard;
+            generateGuard(os, updateGuard(os, guard, state));
+            os << "template<> inline constexpr VkStructureType structureTypeOf<"
+               << getTypeName(structType.m_entry.m_typeId)
+               << "> = " << structType.m_value << ";\n";
+        }
+        updateGuard(os, {}, state);
+        os << '\n';
+        generateTable(os, "structureTypeSeeds", hash.m_seeds);
+        generateTable(os, "structureTypeKeys", hash.m_keys);
+        const auto slotCount = std::to_string(hash.m_keys.size());
+        os << "\n// The slot of an sType in structureTypeKeys, or " << slotCount
+           << " if it's no struct's.\n"
+              "constexpr uint32_t structureTypeSlot(VkStructureType sType) "
+              "noexcept {\n"
+              "  const auto key = uint32_t(sType);\n"
+              "  const auto seed = structureTypeSeeds[(key * 0x9e3779b1u) >> "
+           << std::to_string(32 - hash.m_bucketBits)
+           << "];\n"
+              "  const auto slot = ((key ^ seed) * 0x85ebca6bu) >> "
+           << std::to_string(32 - hash.m_slotBits)
+           << ";\n"
+              "  return structureTypeKeys[slot] == key ? slot : "
+           << slotCount
+           << ";\n"
+              "}\n";
+        os << "\n"
+              "// Calls visitor with every struct in the chain it can be "
+              "called with.\n"
+              "template<class Visitor>\n"
+              "void visitChain(const void* chain, Visitor&& visitor) {\n"
+              "  for (auto p = static_cast<const VkBaseInStructure*>(chain); "
+              "p; p = p->pNext) {\n"
+              "    switch (structureTypeSlot(p->sType)) {\n";
+        for (const auto& structType : structTypes) {
+            const auto guard = structType.m_entry.m_guard;
+            generateGuard(os, updateGuard(os, guard, state));
+            const auto name = getTypeName(structType.m_entry.m_typeId);
+            os.format("    case {}: visitStruct(visitor, "
+                      "*reinterpret_cast<const {}*>(p)); break;\n",
+                      hash.getSlot(structType.m_key), name);
+        }
+        updateGuard(os, {}, state);
+        os << "    default: break;\n"
+              "    }\n"
+              "  }\n"
+              "}\n";
+        if (!m_reflection)
+            return;
+        const auto reflected = getReflected(entries);
+        os << "\n"
+              "// The members of the struct with an sType, empty if it's no "
+              "struct's.\n"
+              "inline std::span<const MemberInfo> getMembers(VkStructureType "
+              "sType) noexcept {\n"
+              "  switch (structureTypeSlot(sType)) {\n";
+        for (const auto& structType : structTypes) {
+            const auto name = getTypeName(structType.m_entry.m_typeId);
+            if (!reflected.contains(name))
+                continue;
+            const auto guard = structType.m_entry.m_guard;
+            generateGuard(os, updateGuard(os, guard, state));
+            os.format("  case {}: return getMembers<{}>();\n",
+                      hash.getSlot(structType.m_key), name);
+        }
+        updateGuard(os, {}, state);
+        os << "  default: return {};\n"
+              "  }\n"
+              "}\n";
+    }
+
+    // Whether a member is a bit-field, which has no offset.
+    bool isBitField(const Element& member) const {
+        bool afterName = false;
+        for (const auto child : m_ctx.getList(member.children)) {
+            if (child.getKind() == NodeKind::Text) {
+                const auto str = m_ctx.get(StrId{child.getIndex()});
+                const auto pos = str.find_first_not_of(' ');
+                if (afterName && pos != std::string_view::npos &&
+                    str[pos] == ':')
+                    return true;
+                afterName = false;
+            } else {
+                afterName =
+                    m_ctx.get(Idx<Element>{child.getIndex()}).tag == nameTag;
+            }
+        }
+        return false;
+    }
+
+    // The MemberKind of a value of this type, stored inline.
+    std::string_view getValueKind(std::string_view type,
+                                  const boost::unordered_flat_set<
+                                      std::string_view>& reflected) const {
+        if (reflected.contains(type))
+            return "Struct";
+        if (m_handleCommands.contains(type))
+            return "Handle";
+        return "Value";
+    }
+
+    // The structs without bit-fields, which have a Reflection.
+    boost::unordered_flat_set<std::string_view>
+    getReflected(std::span<const TypeEntry> entries) const {
+        boost::unordered_flat_set<std::string_view> reflected;
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Struct)
+                continue;
+            const auto& typeInfo = m_typeInfos[entry.m_typeId.getIndex()];
+            bool bitField = false;
+            processChildElems(*typeInfo.m_elem, memberTag,
+                              [&](const Element& elem) {
+                                  if (isBitField(elem))
+                                      bitField = true;
+                              });
+            if (!bitField)
+                reflected.insert(typeInfo.m_name);
+        }
+        return reflected;
+    }
+
+    struct ReflectedMember {
+        MemberInfo m_info;
+        std::string_view m_len;
+        // The C expression of a len given as a formula, e.g. "codeSize / 4".
+        std::string_view m_altlen;
+    };
+
+    // The count of an array from its altlen, as the body of a function
+    // taking the struct as `p`, setting countIndex to the first member it
+    // reads.
+    static std::string
+    getCountFunction(std::string_view vkName, std::string_view altlen,
+                     std::span<const ReflectedMember> members,
+                     int& countIndex) {
+        const auto isIdentifier = [](char c, bool first) {
+            return c == '_' || (c >= 'a' && c <= 'z') ||
+                   (c >= 'A' && c <= 'Z') || (!first && c >= '0' && c <= '9');
+        };
+        std::string expr;
+        for (std::size_t i = 0; i != altlen.size();) {
+            if (!isIdentifier(altlen[i], true)) {
+                expr += altlen[i++];
+                continue;
             }
-            switch (kind) {
-            case TypeKind::Raw: generateRaw(os, typeId, state); break;
-            case TypeKind::Enum: generateEnum(os, typeId, state); break;
-            case TypeKind::Bitmask: generateBitmask(os, typeId, state); break;
-            case TypeKind::Alias: generateAlias(os, typeId, state); break;
-            case TypeKind::Struct: generateStruct(os, typeId, state); break;
-            case TypeKind::Handle: generateHandle(os, typeId, state); break;
-            default: break;
+            auto end = i + 1;
+            while (end != altlen.size() && isIdentifier(altlen[end], false))
+                ++end;
+            const auto name = altlen.substr(i, end - i);
+            for (std::size_t j = 0; j != members.size(); ++j) {
+                if (members[j].m_info.m_name != name)
+                    continue;
+                expr += "s.";
+                if (countIndex < 0)
+                    countIndex = int(j);
             }
+            expr += name;
+            i = end;
         }
+        std::string body("const auto& s = *static_cast<const ");
+        body.append(vkName).append("*>(p); return std::size_t(");
+        body.append(expr).append(");");
+        return body;
+    }
+
+    void generateReflection(Output& os,
+                            std::span<const TypeEntry> entries) const {
+        const auto reflected = getReflected(entries);
+        GenState state{.m_delim = true};
+        for (const auto& entry : entries) {
+            if (entry.m_typeId.getKind() != TypeKind::Struct)
+                continue;
+            const auto& typeInfo = m_typeInfos[entry.m_typeId.getIndex()];
+            if (!reflected.contains(typeInfo.m_name))
+                continue;
+            std::vector<ReflectedMember> members;
+            processChildElems(
+                *typeInfo.m_elem, memberTag, [&](const Element& elem) {
+                    const auto attrs = m_ctx.getList(elem.attrs);
+                    if (!checkApi(attrs))
+                        return;
+                    auto& member = members.emplace_back(
+                        ReflectedMember{getMemberInfo(elem)});
+                    if (const auto lenAttr = findAttr(attrs, lenTag))
+                        member.m_len = m_ctx.get(lenAttr);
+                    if (const auto altlenAttr = findAttr(attrs, altlenTag))
+                        member.m_altlen = m_ctx.get(altlenAttr);
+                });
+            const auto guard = updateGuard(os, entry.m_guard, state);
+            if (state.m_delim) {
+                os << '\n';
+                state.m_delim = false;
+            }
+            generateGuard(os, guard);
+            const auto vkName = "Vk" + std::string(typeInfo.m_name);
+            os << "template<> struct Reflection<" << typeInfo.m_name
+               << "> {\n"
+                  "  static constexpr MemberInfo members[] = {\n";
+            for (const auto& [member, len, altlen] : members) {
+                os << "    {\"" << member.m_name << "\", offsetof(" << vkName
+                   << ", " << member.m_name << "), sizeof(" << vkName
+                   << "::" << member.m_name << "), MemberKind::";
+                std::string_view elementKind;
+                std::string_view elementType;
+                int countIndex = -1;
+                // Set if the count is a formula rather than a member.
+                std::string countFunction;
+                if (member.m_name == "pNext") {
+                    os << "Next";
+                } else if (!member.m_isPtr) {
+                    const auto kind = getValueKind(member.m_type, reflected);
+                    os << kind;
+                    if (kind == "Struct")
+                        elementType = member.m_type;
+                } else {
+                    const auto pos = len.find(',');
+                    const auto count = len.substr(0, pos);
+                    const auto rest = pos == std::string_view::npos
+                                          ? std::string_view()
+                                          : len.substr(pos + 1);
+                    if (!altlen.empty()) {
+                        countFunction = getCountFunction(vkName, altlen,
+                                                         members, countIndex);
+                    } else {
+                        for (std::size_t i = 0; i != members.size(); ++i) {
+                            if (members[i].m_info.m_name == count)
+                                countIndex = int(i);
+                        }
+                    }
+                    const bool counted =
+                        countIndex >= 0 || !countFunction.empty();
+                    const bool single =
+                        member.m_typeSuffix.find('*') ==
+                        member.m_typeSuffix.rfind('*');
+                    if (count == "null-terminated" && single &&
+                        member.m_type == "char") {
+                        os << "String";
+                    } else if (countIndex >= 0 && !single &&
+                               rest == "null-terminated") {
+                        os << "Array";
+                        elementKind = "String";
+                    } else if (counted && single && member.m_type == "void") {
+                        // Bytes, e.g. specialization data.
+                        os << "Array";
+                        elementKind = "Value";
+                    } else if ((counted || len.empty()) && single &&
+                               member.m_type != "void") {
+                        os << "Array";
+                        elementKind =
+                            getValueKind(member.m_type, reflected);
+                        if (elementKind == "Struct")
+                            elementType = member.m_type;
+                    } else {
+                        os << "Pointer";
+                        countIndex = -1;
+                        countFunction.clear();
+                    }
+                }
+                if (!elementKind.empty() || !elementType.empty()) {
+                    os << ", MemberKind::"
+                       << (elementKind.empty() ? "Value" : elementKind)
+                       << ", ";
+                    if (member.m_type == "void")
+                        os << '1';
+                    else if (member.m_isPtr)
+                        os << "sizeof(*" << vkName << "::" << member.m_name
+                           << ')';
+                    else
+                        os << "sizeof(Vk" << member.m_type << ')';
+                    os.format(", {}", countIndex);
+                    if (!elementType.empty())
+                        os << ", &getMembers<" << elementType << '>';
+                    else if (!countFunction.empty())
+                        os << ", nullptr";
+                    if (!countFunction.empty())
+                        os << ",\n     [](const void* p) noexcept { "
+                           << countFunction << " }";
+                }
+                os << "},\n";
+            }
+            os << "  };\n"
+                  "};\n";
+        }
+        updateGuard(os, {}, state);
+    }
+
+    void generateGlobalCommands(Output& os, GenState& state) const {
         state.m_delim = true;
         for (const auto& cmd : m_globalCommands) {
             generateCommand(os, cmd, {}, {}, state);
         }
         updateGuard(os, {}, state);
-        os << "}\n"
-              "\n"
-              "#endif // VKLITE_VULKAN_HPP";
+    }
+
+    // Decides whether a type is emitted and how it's separated from the
+    // previous one, this is all that depends on the types before it.
+    bool prepareType(TypeId typeId, TypeEntry& entry) const {
+        const auto support = findSupport(getTypeName(typeId));
+        if (!support)
+            return false;
+        entry.m_typeId = typeId;
+        entry.m_guard = *support;
+        switch (typeId.getKind()) {
+        case TypeKind::Enum: {
+            NameMatch match;
+            if (!matchEnumName(m_typeInfos[typeId.getIndex()], match))
+                return false;
+            entry.m_spaced = true;
+            break;
+        }
+        case TypeKind::Bitmask:
+            entry.m_spaced = isFlagSet(m_bitmaskInfo[typeId.getIndex()]);
+            break;
+        case TypeKind::Struct: entry.m_spaced = true; break;
+        default: break;
+        }
+        return true;
+    }
+
+    void generateType(Output& os, const TypeEntry& entry) const {
+        const auto typeId = entry.m_typeId;
+        switch (typeId.getKind()) {
+        case TypeKind::Raw: generateRaw(os, typeId); break;
+        case TypeKind::Enum: generateEnum(os, typeId); break;
+        case TypeKind::Bitmask: generateBitmask(os, typeId); break;
+        case TypeKind::Alias: generateAlias(os, typeId); break;
+        case TypeKind::Struct: generateStruct(os, typeId, entry.m_guard); break;
+        case TypeKind::Handle: generateHandle(os, typeId, entry.m_guard); break;
+        default: break;
+        }
+    }
+
+    // Generates the type bodies on `jobs` threads, each into its own buffer.
+    // Threads pick the next entry as they finish, since struct and handle
+    // bodies vary a lot in cost.
+    std::vector<std::string> renderTypes(std::span<const TypeEntry> entries,
+                                         unsigned jobs) const {
+        std::vector<std::string> bodies(entries.size());
+        std::atomic<std::size_t> next = 0;
+        const auto work = [&] {
+            for (;;) {
+                const auto i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= entries.size())
+                    break;
+                Output os;
+                generateType(os, entries[i]);
+                bodies[i] = std::move(os.str());
+            }
+        };
+        std::vector<std::jthread> threads;
+        threads.reserve(jobs - 1);
+        for (unsigned n = 1; n != jobs; ++n)
+            threads.emplace_back(work);
+        work();
+        threads.clear();
+        return bodies;
     }
 
     static bool isCapital(char c) { return 'A' <= c && c <= 'Z'; }
@@ -483,41 +1890,23 @@ struct Builder {
         m_raws.insert(name);
     }
 
-    void generateRaw(Output& os, TypeId typeId, GenState& state) {
+    void generateRaw(Output& os, TypeId typeId) const {
         const auto& typeInfo = m_typeInfos[typeId.getIndex()];
-        const auto support = findSupport(typeInfo.m_name);
-        if (!support)
-            return;
-        const auto guard = updateGuard(os, *support, state);
-        if (state.m_delim) {
-            os << '\n';
-            state.m_delim = false;
-        }
-        generateGuard(os, guard);
         os << "using " << typeInfo.m_name << " = Vk" << typeInfo.m_name
            << ";\n";
     }
 
-    void generateBitmask(Output& os, TypeId typeId, GenState& state) {
+    bool isFlagSet(const BitmaskInfo& bitmaskInfo) const {
+        return !bitmaskInfo.m_enum.empty() &&
+               m_supported.contains(bitmaskInfo.m_enum);
+    }
+
+    void generateBitmask(Output& os, TypeId typeId) const {
         const auto& bitmaskInfo = m_bitmaskInfo[typeId.getIndex()];
-        const auto support = findSupport(bitmaskInfo.m_name);
-        if (!support)
-            return;
-        if (bitmaskInfo.m_enum.empty() ||
-            !m_supported.contains(bitmaskInfo.m_enum)) {
-            const auto guard = updateGuard(os, *support, state);
-            if (state.m_delim) {
-                os << '\n';
-                state.m_delim = false;
-            }
-            generateGuard(os, guard);
+        if (!isFlagSet(bitmaskInfo)) {
             os << "using " << bitmaskInfo.m_name << " = " << bitmaskInfo.m_type
                << ";\n";
         } else {
-            const auto guard = updateGuard(os, *support, state);
-            os << '\n';
-            state.m_delim = true;
-            generateGuard(os, guard);
             os << "using " << bitmaskInfo.m_name << " = FlagSet<"
                << bitmaskInfo.m_enum << ", " << bitmaskInfo.m_type << ">;\n";
             os << "constexpr " << bitmaskInfo.m_name << " operator|("
@@ -525,58 +1914,67 @@ struct Builder {
                << " b) noexcept { return " << bitmaskInfo.m_name << '('
                << bitmaskInfo.m_type << "(a) | " << bitmaskInfo.m_type
                << "(b)); }\n";
+            if (m_parse && m_module) {
+                os << "VKLITE_INSTANTIATE_PARSE(" << bitmaskInfo.m_name
+                   << ")\n";
+            }
         }
     }
 
-    void generateAlias(Output& os, TypeId typeId, GenState& state) {
+    void generateAlias(Output& os, TypeId typeId) const {
         const auto& defInfo = m_defInfo[typeId.getIndex()];
-        const auto support = findSupport(defInfo.m_name);
-        if (!support)
-            return;
-        const auto guard = updateGuard(os, *support, state);
-        if (state.m_delim) {
-            os << '\n';
-            state.m_delim = false;
-        }
-        generateGuard(os, guard);
         os << "using " << defInfo.m_name << " = " << defInfo.m_def << ";\n";
     }
 
-    void generateEnum(Output& os, TypeId typeId, GenState& state) {
-        const auto& typeInfo = m_typeInfos[typeId.getIndex()];
-        const auto support = findSupport(typeInfo.m_name);
-        if (!support)
-            return;
-        NameMatch match;
+    bool isBitmaskEnum(const TypeInfo& typeInfo) const {
+        const auto attrs = m_ctx.getList(typeInfo.m_elem->attrs);
+        return isValue(findAttr(attrs, typeTag), bitmaskValue);
+    }
+
+    // Matches the name for the prefix of the values, without the FlagBits
+    // suffix of bitmasks.
+    bool matchEnumName(const TypeInfo& typeInfo, NameMatch& match) const {
         if (!matchName(typeInfo.m_name, match)) {
             print("BAD NAME: {}\n", typeInfo.m_name);
-            return;
+            return false;
         }
-        const auto attrs = m_ctx.getList(typeInfo.m_elem->attrs);
-        const bool isBitmask = m_ctx.get(findAttr(attrs, typeTag)) == "bitmask";
-        if (isBitmask) {
+        if (isBitmaskEnum(typeInfo)) {
             if (!match.m_str.ends_with("FlagBits")) {
                 print("BAD BITMASK NAME: {}\n", match.m_str);
-                return;
+                return false;
             }
             match.m_str.remove_suffix(8);
         }
-        const auto guard = updateGuard(os, *support, state);
-        os << '\n';
-        state.m_delim = true;
-        generateGuard(os, guard);
-        if (const auto commentAttr = findAttr(attrs, commentTag)) {
-            os << "// " << m_ctx.get(commentAttr) << '\n';
-        }
-        os << "enum class " << typeInfo.m_name << " : ";
+        return true;
+    }
+
+    std::string getEnumValueType(const TypeInfo& typeInfo) const {
+        const auto attrs = m_ctx.getList(typeInfo.m_elem->attrs);
+        std::string valueType;
         if (const auto bitwidthAttr = findAttr(attrs, bitwidthTag)) {
-            os << "uint" << m_ctx.get(bitwidthAttr) << "_t";
+            valueType += "uint";
+            valueType += m_ctx.get(bitwidthAttr);
+            valueType += "_t";
         } else {
-            if (isBitmask)
-                os << 'u';
-            os << "int32_t";
+            if (isBitmaskEnum(typeInfo))
+                valueType += 'u';
+            valueType += "int32_t";
+        }
+        return valueType;
+    }
+
+    void generateEnum(Output& os, TypeId typeId) const {
+        const auto& typeInfo = m_typeInfos[typeId.getIndex()];
+        NameMatch match;
+        matchEnumName(typeInfo, match);
+        const auto attrs = m_ctx.getList(typeInfo.m_elem->attrs);
+        const bool isBitmask = isBitmaskEnum(typeInfo);
+        if (const auto commentAttr = findAttr(attrs, commentTag)) {
+            os << "// " << m_ctx.get(commentAttr) << '\n';
         }
-        os << " {\n";
+        const auto valueType = getEnumValueType(typeInfo);
+        os << "enum class " << typeInfo.m_name << " : " << valueType
+           << " {\n";
         std::string prefix("VK_");
         const bool isResult = typeInfo.m_name == "Result";
         if (!isResult) [[likely]] {
@@ -588,9 +1986,11 @@ struct Builder {
             prefix += '_';
         }
         std::vector<std::pair<std::string, GuardId>> resultEnums;
+        std::vector<EnumText> texts;
         boost::unordered_flat_set<std::string_view> uniqueIds;
         GenState stateEnum;
-        const auto each = [&](const Element& elem, GuardId extGuard = {}) {
+        const auto each = [&](const Element& elem, GuardId extGuard = {},
+                              std::string_view extNumber = {}) {
             const auto attrs = m_ctx.getList(elem.attrs);
             if (findAttr(attrs, deprecatedTag))
                 return;
@@ -617,6 +2017,10 @@ struct Builder {
                 os << "  // " << m_ctx.get(commentAttr) << '\n';
             }
             os << "  " << eName << " = " << name << ",\n";
+            if ((m_toString || m_parse) && !findAttr(attrs, aliasTag)) {
+                if (const auto value = getEnumValue(elem, extNumber))
+                    texts.push_back({eName.substr(1), name, *value});
+            }
             if (isResult) [[unlikely]] {
                 if (!findAttr(attrs, aliasTag))
                     resultEnums.emplace_back(std::move(eName), extGuard);
@@ -624,10 +2028,19 @@ struct Builder {
         };
         processChildElems(*typeInfo.m_elem, enumTag, each);
         for (const auto enumExtend : findEnumExtends(typeInfo.m_name)) {
-            each(enumExtend.m_elem, enumExtend.m_guard);
+            each(enumExtend.m_elem, enumExtend.m_guard, enumExtend.m_extNumber);
         }
         updateGuard(os, {}, stateEnum);
         os << "};\n";
+        if (m_toString || m_parse)
+            generateEnumText(os, typeInfo.m_name, valueType, texts, m_parse);
+        if (m_parse && m_module)
+            os << "VKLITE_INSTANTIATE_PARSE(" << typeInfo.m_name << ")\n";
+        if (m_toString && isResult) {
+            os << "\ninline const char* getResultText(Result r) noexcept "
+                  "{ return toString(r).data(); }\n";
+            return;
+        }
         if (isResult) [[unlikely]] {
             os << "\ninline const char* getResultText(Result r) noexcept {\n"
                   "  using enum Result;\n"
@@ -648,6 +2061,139 @@ struct Builder {
         }
     }
 
+    struct EnumText {
+        std::string m_name;
+        std::string_view m_vkName;
+        int64_t m_value;
+    };
+
+    // The FNV-1a hash of a name, as hashName in parse.hpp.
+    static uint32_t hashName(std::string_view str, uint32_t seed) {
+        uint32_t h = 0x811c9dc5u ^ seed;
+        for (const char c : str)
+            h = (h ^ uint8_t(c)) * 0x01000193u;
+        return h;
+    }
+
+    // Generates the EnumText of an enum: its names in a pool of strings,
+    // sorted by value, and either the values or the first one if they're
+    // contiguous. For parse, also the VK_ names and a perfect hash of both.
+    static void generateEnumText(Output& os, std::string_view name,
+                                 std::string_view valueType,
+                                 std::vector<EnumText>& texts, bool parse) {
+        const bool isSigned = !valueType.starts_with('u');
+        const auto less = [&](const EnumText& a, const EnumText& b) {
+            return isSigned ? a.m_value < b.m_value
+                            : uint64_t(a.m_value) < uint64_t(b.m_value);
+        };
+        std::ranges::stable_sort(texts, less);
+        const auto [e, end] = std::ranges::unique(
+            texts, {}, [](const EnumText& text) { return text.m_value; });
+        texts.erase(e, end);
+        const auto toString = [&](int64_t value) {
+            return isSigned ? std::to_string(value)
+                            : std::to_string(uint64_t(value)) + 'u';
+        };
+        const auto generateArray = [&](std::string_view type,
+                                       std::string_view array,
+                                       const auto& values,
+                                       const auto& toString) {
+            os << "  static constexpr " << type << ' ' << array << "[] = {";
+            for (std::size_t i = 0; i != values.size(); ++i) {
+                if (i)
+                    os << ", ";
+                os << toString(values[i]);
+            }
+            os << "};\n";
+        };
+        const auto sizeToString = [](std::size_t i) {
+            return std::to_string(i);
+        };
+        const auto indexType = [](std::size_t max) {
+            return max <= 0xffff ? "uint16_t" : "uint32_t";
+        };
+        // The names, each followed by '\0', and their offsets.
+        const auto generatePool = [&](std::string_view pool,
+                                      std::string_view offsetArray,
+                                      auto getName, bool addEmpty) {
+            std::vector<std::size_t> offsets;
+            std::size_t poolSize = 0;
+            os << "  static constexpr char " << pool << "[] =";
+            if (texts.empty())
+                os << " \"\"";
+            for (const auto& text : texts) {
+                const std::string_view str = getName(text);
+                os << "\n    \"" << str << "\\0\"";
+                offsets.push_back(poolSize);
+                poolSize += str.size() + 1;
+            }
+            os << ";\n";
+            offsets.push_back(poolSize);
+            // The empty name of values without one.
+            if (addEmpty)
+                offsets.push_back(poolSize + 1);
+            generateArray(indexType(offsets.back()), offsetArray, offsets,
+                          sizeToString);
+        };
+        os << "template<> struct EnumText<" << name << "> {\n";
+        generatePool("names", "offsets",
+                     [](const EnumText& text) -> std::string_view {
+                         return text.m_name;
+                     },
+                     true);
+        const bool contiguous =
+            texts.empty() ||
+            uint64_t(texts.back().m_value) - uint64_t(texts.front().m_value) ==
+                texts.size() - 1;
+        if (contiguous) {
+            os << "  static constexpr " << valueType << " first = "
+               << toString(texts.empty() ? 0 : texts.front().m_value)
+               << ";\n";
+        } else {
+            generateArray(valueType, "values", texts,
+                          [&](const EnumText& text) {
+                              return toString(text.m_value);
+                          });
+        }
+        if (parse) {
+            generatePool("vkNames", "vkOffsets",
+                         [](const EnumText& text) { return text.m_vkName; },
+                         false);
+            // The names, then the VK_ names, hashed with the first seed that
+            // tells them apart.
+            std::vector<uint32_t> keys;
+            uint32_t hashSeed = 0;
+            for (;; ++hashSeed) {
+                keys.clear();
+                for (const auto& text : texts)
+                    keys.push_back(hashName(text.m_name, hashSeed));
+                for (const auto& text : texts)
+                    keys.push_back(hashName(text.m_vkName, hashSeed));
+                auto sorted = keys;
+                std::ranges::sort(sorted);
+                if (std::ranges::adjacent_find(sorted) == sorted.end() &&
+                    !std::ranges::binary_search(sorted, 0x7fffffffu))
+                    break;
+            }
+            const auto hash = makePerfectHash(keys);
+            std::vector<std::size_t> indices(hash.m_keys.size());
+            for (std::size_t i = 0; i != keys.size(); ++i)
+                indices[hash.getSlot(keys[i])] = i;
+            os.format("  static constexpr uint32_t hashSeed = {};\n"
+                      "  static constexpr uint32_t bucketShift = {};\n"
+                      "  static constexpr uint32_t slotShift = {};\n",
+                      hashSeed, 32 - hash.m_bucketBits, 32 - hash.m_slotBits);
+            const auto keyToString = [](uint32_t key) {
+                return std::to_string(key) + 'u';
+            };
+            generateArray("uint32_t", "seeds", hash.m_seeds, keyToString);
+            generateArray("uint32_t", "keys", hash.m_keys, keyToString);
+            generateArray(indexType(keys.size()), "indices", indices,
+                          sizeToString);
+        }
+        os << "};\n";
+    }
+
     bool checkApi(std::span<const Attribute> attrs) const {
         if (const auto apiAttr = findAttr(attrs, apiTag)) {
             if (!findCommaList(m_ctx.get(apiAttr), "vulkan"))
@@ -656,7 +2202,8 @@ struct Builder {
         return !findAttr(attrs, deprecatedTag);
     }
 
-    void generateMemberName(Output& os, std::string_view name, bool isPtr) {
+    void generateMemberName(Output& os, std::string_view name,
+                            bool isPtr) const {
         if (isPtr) {
             const auto offset = name.find_first_not_of('p');
             if (offset != 0) {
@@ -707,7 +2254,7 @@ struct Builder {
         return info;
     }
 
-    MemberInfo getMemberInfo(const Element& elem) {
+    MemberInfo getMemberInfo(const Element& elem) const {
         const auto attrs = m_ctx.getList(elem.attrs);
         MemberInfo info{getVarInfo(elem)};
         info.m_optional = !!findAttr(attrs, optionalTag);
@@ -747,7 +2294,7 @@ struct Builder {
 
     void generateMemberInit(Output& os, const MemberInfo& info,
                             std::string_view name,
-                            const char* subName = nullptr) {
+                            const char* subName = nullptr) const {
         const bool addCast = info.m_addCast && !info.m_isStruct;
         if (addCast) {
             os << "std::bit_cast<" << info.m_typePrefix << "Vk" << info.m_type
@@ -760,7 +2307,7 @@ struct Builder {
             os << ')';
     }
 
-    void generateMemberSetSlot(Output& os, const MemberInfo& info) {
+    void generateMemberSetSlot(Output& os, const MemberInfo& info) const {
         if (info.m_isArr) {
             if (info.m_isStr) {
                 os << "const auto len = std::max<std::size_t>(" << info.m_array
@@ -777,7 +2324,7 @@ struct Builder {
         }
     }
 
-    void generateMemberGetSlot(Output& os, const MemberInfo& info) {
+    void generateMemberGetSlot(Output& os, const MemberInfo& info) const {
         if (info.m_isArr) {
             if (info.m_addCast) {
                 os << info.m_newType << "(std::bit_cast<const "
@@ -803,7 +2350,8 @@ struct Builder {
         }
     }
 
-    void generateMember(Output& os, const MemberInfo& info, bool returnedonly) {
+    void generateMember(Output& os, const MemberInfo& info,
+                        bool returnedonly) const {
         if (info.m_tag == VarTag::Slave)
             return;
         if (!info.m_comment.empty())
@@ -864,11 +2412,8 @@ struct Builder {
         return false;
     }
 
-    void generateStruct(Output& os, TypeId typeId, GenState& state) {
+    void generateStruct(Output& os, TypeId typeId, GuardId guard) const {
         const auto& typeInfo = m_typeInfos[typeId.getIndex()];
-        const auto support = findSupport(typeInfo.m_name);
-        if (!support)
-            return;
         const auto attrs = m_ctx.getList(typeInfo.m_elem->attrs);
         const bool returnedonly = !!findAttr(attrs, returnedonlyTag);
         std::vector<MemberInfo> members;
@@ -878,9 +2423,10 @@ struct Builder {
                 if (!checkApi(attrs))
                     return;
                 if (const auto nameTxt = getChildElemText(elem, nameTag)) {
-                    const auto name = m_ctx.get(nameTxt); //
-                    if (name == "pNext" || name == "matrix" ||
-                        name == "ppGeometries" || name == "ppUsageCounts")
+                    if (isValue(nameTxt, pNextValue) ||
+                        isValue(nameTxt, matrixValue) ||
+                        isValue(nameTxt, ppGeometriesValue) ||
+                        isValue(nameTxt, ppUsageCountsValue))
                         return;
                     auto info = getMemberInfo(elem);
                     if (returnedonly) {
@@ -925,10 +2471,6 @@ struct Builder {
                     members.push_back(std::move(info));
                 }
             });
-        const auto guard = updateGuard(os, *support, state);
-        os << '\n';
-        state.m_delim = true;
-        generateGuard(os, guard);
         if (const auto commentAttr = findAttr(attrs, commentTag)) {
             os << "// " << m_ctx.get(commentAttr) << '\n';
         }
@@ -1031,7 +2573,7 @@ struct Builder {
                 if (!supportExt)
                     continue;
                 const auto guardExt = updateGuard(
-                    os, subGuard(state.m_guard, *supportExt), stateExt);
+                    os, subGuard(guard, *supportExt), stateExt);
                 generateGuard(os, guardExt);
                 os << "  void attach";
                 if (m_structExtendsMap.contains(name))
@@ -1049,7 +2591,7 @@ struct Builder {
                 if (consumeMatch(type, "Vk")) {
                     if (const auto supportExt = findSupport(type)) {
                         const auto guardExt = updateGuard(
-                            os, subGuard(state.m_guard, *supportExt), stateExt);
+                            os, subGuard(guard, *supportExt), stateExt);
                         generateGuard(os, guardExt);
                         os << "inline void " << type << "::attach";
                         if (!extends.empty())
@@ -1085,6 +2627,8 @@ struct Builder {
         std::string m_name;
         std::string m_type;
         std::string m_cast;
+        // The len attribute of an array.
+        std::string_view m_len;
         bool m_addPtr = false;
         bool m_isArr = false;
         bool m_optional = false;
@@ -1098,7 +2642,8 @@ struct Builder {
         }
     }
 
-    ParamInfo generateParam(const Element& param, std::string_view& outType) {
+    ParamInfo generateParam(const Element& param,
+                            std::string_view& outType) const {
         const auto attrs = m_ctx.getList(param.attrs);
         const auto optionalAttr = findAttr(attrs, optionalTag);
         auto var = getVarInfo(param);
@@ -1113,7 +2658,7 @@ struct Builder {
             info.m_type += "std::span<";
         info.m_type += var.m_typePrefix;
         info.m_type += var.m_type;
-        info.m_optional = optionalAttr && m_ctx.get(optionalAttr) == "true";
+        info.m_optional = isValue(optionalAttr, trueValue);
         if (isPtr && !findAttr(attrs, lenTag)) {
             if (!optionalAttr && var.m_typePrefix.starts_with("const") &&
                 type != "void") {
@@ -1142,7 +2687,7 @@ struct Builder {
     }
 
     void generateFnName(Output& os, std::string_view typeName,
-                        std::string_view name) {
+                        std::string_view name) const {
         if (consumeMatch(name, "Get")) {
             os << "get";
             consumeMatch(name, typeName);
@@ -1162,9 +2707,15 @@ struct Builder {
         os << name;
     }
 
+    // How a handle method is written: in its class, or declared there and
+    // defined after it, for the split headers. Check writes a function
+    // calling it and checking its result instead, see generateChecks.
+    enum class MethodPart { Inline, Declaration, Definition, Check };
+
     void generateCommand(Output& os, const CommandInfo& cmd,
                          std::string_view typeName, GuardId baseGuard,
-                         GenState& state) {
+                         GenState& state, std::string_view callee = "vk",
+                         MethodPart part = MethodPart::Inline) const {
         auto name = m_ctx.get(cmd.m_name);
         if (!consumeMatch(name, "vk"))
             return;
@@ -1191,8 +2742,9 @@ struct Builder {
             outType = {};
             auto info = generateParam(param, outType);
             if (const auto lenAttr = findAttr(attrs, lenTag)) {
+                info.m_len = m_ctx.get(lenAttr);
                 if (!info.m_optional)
-                    info.m_optional = isAnyOptional(params, m_ctx.get(lenAttr));
+                    info.m_optional = isAnyOptional(params, info.m_len);
             }
             if (!params.empty() && info.m_name == "objectHandle" &&
                 info.m_type == "uint64_t") {
@@ -1237,6 +2789,11 @@ struct Builder {
                 }
             }
         }
+        if (useOut)
+            params.pop_back();
+        fixOptional(params);
+        if (part == MethodPart::Check && type != "Result")
+            return;
         const auto guard =
             updateGuard(os, subGuard(baseGuard, *support), state);
         if (state.m_delim) {
@@ -1244,16 +2801,173 @@ struct Builder {
             state.m_delim = false;
         }
         generateGuard(os, guard);
-        os << (typeName.empty() ? "inline " : "  ");
-        if (useOut) {
-            params.pop_back();
-            if (useRet)
-                os << "Ret<" << outType << "> ";
+        // Methods calling the global entry points can call any dispatcher
+        // with the same members instead, e.g. DeviceDispatch.
+        const bool policy =
+            m_dispatchPolicy && !typeName.empty() && callee == "vk";
+        if (policy)
+            callee = "dispatch.vk";
+        const bool definition = part == MethodPart::Definition;
+        const auto generateCall = [&](std::span<const ParamInfo> params,
+                                      std::string_view checks) {
+            if (part == MethodPart::Check) {
+                generateCheck(os, typeName, name, params, useOut);
+                return;
+            }
+            if (policy && definition)
+                os << "template<class Dispatch> ";
+            else if (policy)
+                os << "  template<class Dispatch = GlobalDispatch> ";
             else
-                os << outType << ' ';
-        } else {
-            os << type << ' ';
+                os << (typeName.empty() || definition ? "inline " : "  ");
+            if (useOut) {
+                if (useRet)
+                    os << "Ret<" << outType << "> ";
+                else
+                    os << outType << ' ';
+            } else {
+                os << type << ' ';
+            }
+            if (definition)
+                os << typeName << "::";
+            generateFnName(os, typeName, name);
+            os << '(';
+            bool delim = false;
+            for (const auto& param : params) {
+                if (param.m_optional || param.m_tag == VarTag::Slave)
+                    continue;
+                if (delim)
+                    os << ", ";
+                else
+                    delim = true;
+                os << param.m_type << ' ' << param.m_name;
+            }
+            for (const auto& param : params) {
+                if (!param.m_optional || param.m_tag == VarTag::Slave)
+                    continue;
+                if (delim)
+                    os << ", ";
+                else
+                    delim = true;
+                os << param.m_type << ' ' << param.m_name;
+                if (!definition)
+                    os << " = {}";
+            }
+            if (policy) {
+                os << (delim ? ", " : "") << "const Dispatch& dispatch";
+                if (!definition)
+                    os << " = {}";
+            }
+            os << ") ";
+            if (!typeName.empty())
+                os << "const";
+            if (part == MethodPart::Declaration) {
+                os << ";\n";
+                return;
+            }
+            os << (typeName.empty() ? "{ " : " { ");
+            if (m_trace)
+                os << "VKLITE_TRACE_CALL(e" << name << "); ";
+            os << checks;
+            auto suffix = ")";
+            if (useOut) {
+                os << outType << " value; ";
+                if (useRet) {
+                    os << "return {Result(";
+                    suffix = ")), value}";
+                } else {
+                    suffix = "); return value";
+                }
+            } else if (type == "Result") {
+                os << "return Result(";
+                suffix = "))";
+            } else if (type != "void") {
+                os << "return ";
+            }
+            os << callee << name << '(';
+            delim = false;
+            if (!typeName.empty()) {
+                os << "this->handle";
+                delim = true;
+            }
+            for (const auto& param : params) {
+                if (param.m_tag == VarTag::Master)
+                    continue;
+                if (delim)
+                    os << ", ";
+                else
+                    delim = true;
+                if (!param.m_cast.empty())
+                    os << "std::bit_cast<" << param.m_cast << ">(";
+                if (param.m_addPtr)
+                    os << '&';
+                os << param.m_name;
+                if (param.m_isArr)
+                    os << ".data()";
+                if (!param.m_cast.empty())
+                    os << ')';
+            }
+            if (useOut) {
+                if (delim)
+                    os << ", ";
+                if (outParam.m_cast.empty())
+                    os << "&value";
+                else
+                    os << "std::bit_cast<" << outParam.m_cast << ">(&value)";
+            }
+            os << suffix;
+            os << "; }\n";
+        };
+        generateCall(params, {});
+        if (m_spans) {
+            auto spanParams = params;
+            std::string checks;
+            if (collapseSpans(spanParams, checks)) {
+                fixOptional(spanParams);
+                generateCall(spanParams, checks);
+            }
         }
+        if (m_enumerate && part != MethodPart::Check &&
+            (type == "Result" || type == "void") && isEnumeration(params))
+            generateEnumerate(os, typeName, name, type, params, policy,
+                              part);
+    }
+
+    // A function taking the handle and the parameters of its method, and
+    // checking the result of calling it, for MethodPart::Check.
+    void generateCheck(Output& os, std::string_view typeName,
+                       std::string_view name,
+                       std::span<const ParamInfo> params, bool useOut) const {
+        const auto generateParams = [&](bool withTypes) {
+            bool delim = withTypes;
+            for (const bool optional : {false, true}) {
+                for (const auto& param : params) {
+                    if (param.m_optional != optional ||
+                        param.m_tag == VarTag::Slave)
+                        continue;
+                    if (delim)
+                        os << ", ";
+                    else
+                        delim = true;
+                    if (withTypes)
+                        os << param.m_type << ' ';
+                    os << param.m_name;
+                }
+            }
+        };
+        os << "void " << typeName << '_';
+        generateFnName(os, typeName, name);
+        os << '(' << typeName << " self";
+        generateParams(true);
+        os << ") { " << (useOut ? "self." : "check(self.");
+        generateFnName(os, typeName, name);
+        os << '(';
+        generateParams(false);
+        os << (useOut ? ").get(); }\n" : ")); }\n");
+    }
+
+    // Parameters before the last required one can't have default arguments.
+    static void fixOptional(std::vector<ParamInfo>& params) {
         auto lastNonOpt = params.end();
         for (const auto b = params.begin(); lastNonOpt != b;) {
             --lastNonOpt;
@@ -1264,105 +2978,136 @@ struct Builder {
             if (p->m_optional && p->m_name != "pAllocator")
                 p->m_optional = false;
         }
-        generateFnName(os, typeName, name);
-        os << '(';
-        bool delim = false;
-        for (const auto& param : params) {
-            if (param.m_optional || param.m_tag == VarTag::Slave)
+    }
+
+    // Replaces the const pointers whose len is a uint32_t parameter by
+    // spans, and passes the size of the first required one as that count.
+    // The others sharing it are checked to have the same size in debug
+    // builds, an optional one may be empty instead. Returns false if there
+    // are none.
+    static bool collapseSpans(std::vector<ParamInfo>& params,
+                              std::string& checks) {
+        bool any = false;
+        for (auto& count : params) {
+            if (count.m_type != "uint32_t" || count.m_tag != VarTag::Normal)
                 continue;
-            if (delim)
-                os << ", ";
-            else
-                delim = true;
-            os << param.m_type << ' ' << param.m_name;
-        }
-        for (const auto& param : params) {
-            if (!param.m_optional || param.m_tag == VarTag::Slave)
+            std::vector<ParamInfo*> arrs;
+            for (auto& param : params) {
+                if (param.m_len == count.m_name && !param.m_isArr &&
+                    param.m_type.starts_with("const ") &&
+                    param.m_type.ends_with('*') &&
+                    param.m_type != "const void*")
+                    arrs.push_back(&param);
+            }
+            if (arrs.empty())
                 continue;
-            if (delim)
-                os << ", ";
-            else
-                delim = true;
-            os << param.m_type << ' ' << param.m_name << " = {}";
+            std::ranges::stable_partition(
+                arrs, [](const ParamInfo* arr) { return !arr->m_optional; });
+            for (const auto arr : arrs) {
+                arr->m_type.pop_back();
+                arr->m_type.insert(0, "std::span<").push_back('>');
+                renamePtrName(arr->m_name);
+                arr->m_isArr = true;
+                if (arr == arrs.front())
+                    continue;
+                checks += "assert(";
+                if (arr->m_optional)
+                    checks.append(arr->m_name).append(".empty() || ");
+                checks.append(arr->m_name).append(".size() == ");
+                checks.append(arrs.front()->m_name).append(".size()); ");
+                arr->m_optional = false;
+            }
+            arrs.front()->m_optional = false;
+            count.m_name = "uint32_t(" + arrs.front()->m_name + ".size())";
+            count.m_tag = VarTag::Slave;
+            any = true;
         }
+        return any;
+    }
+
+    // A command filling `T* pData` with up to `*pCount` elements, see
+    // vklite::enumerate.
+    static bool isEnumeration(std::span<const ParamInfo> params) {
+        if (params.size() < 2)
+            return false;
+        const auto& count = params[params.size() - 2];
+        const auto& data = params.back();
+        if (count.m_name != data.m_len || count.m_type != "uint32_t*" ||
+            data.m_isArr || !data.m_type.ends_with('*') ||
+            data.m_type.starts_with("const") || data.m_type == "void*")
+            return false;
+        return std::ranges::none_of(params.first(params.size() - 2),
+                                    [](const ParamInfo& param) {
+                                        return param.m_optional;
+                                    });
+    }
+
+    void generateEnumerate(Output& os, std::string_view typeName,
+                           std::string_view name, std::string_view type,
+                           std::span<const ParamInfo> params, bool policy,
+                           MethodPart part) const {
+        const auto& count = params[params.size() - 2];
+        const auto& data = params.back();
+        const auto args = params.first(params.size() - 2);
+        const bool definition = part == MethodPart::Definition;
+        os << (typeName.empty() || definition ? "" : "  ")
+           << "template<EnumerateOutput Container";
+        if (policy)
+            os << (definition ? ", class Dispatch"
+                              : ", class Dispatch = GlobalDispatch");
+        os << '>' << (typeName.empty() || definition ? " inline " : " ")
+           << type << ' ';
+        if (definition)
+            os << typeName << "::";
+        generateFnName(os, typeName, name);
+        os << '(';
+        for (const auto& param : args) {
+            if (param.m_tag != VarTag::Slave)
+                os << param.m_type << ' ' << param.m_name << ", ";
+        }
+        os << "Container& out";
+        if (policy)
+            os << (definition ? ", const Dispatch& dispatch"
+                              : ", const Dispatch& dispatch = {}");
         os << ") ";
         if (!typeName.empty())
-            os << "const ";
-        os << "{ ";
-        auto suffix = ")";
-        if (useOut) {
-            os << outType << " value; ";
-            if (useRet) {
-                os << "return {Result(";
-                suffix = ")), value}";
-            } else {
-                suffix = "); return value";
-            }
-        } else if (type == "Result") {
-            os << "return Result(";
-            suffix = "))";
-        } else if (type != "void") {
-            os << "return ";
-        }
-        os << "vk" << name << '(';
-        delim = false;
-        if (!typeName.empty()) {
-            os << "this->handle";
-            delim = true;
-        }
-        for (const auto& param : params) {
-            if (param.m_tag == VarTag::Master)
-                continue;
-            if (delim)
-                os << ", ";
-            else
-                delim = true;
-            if (!param.m_cast.empty())
-                os << "std::bit_cast<" << param.m_cast << ">(";
-            if (param.m_addPtr)
-                os << '&';
-            os << param.m_name;
-            if (param.m_isArr)
-                os << ".data()";
-            if (!param.m_cast.empty())
-                os << ')';
+            os << "const";
+        if (part == MethodPart::Declaration) {
+            os << ";\n";
+            return;
         }
-        if (useOut) {
-            if (delim)
-                os << ", ";
-            if (outParam.m_cast.empty())
-                os << "&value";
-            else
-                os << "std::bit_cast<" << outParam.m_cast << ">(&value)";
+        os << (typeName.empty() ? "{ " : " { ")
+           << "return enumerate(out, [&](" << count.m_type << ' '
+           << count.m_name << ", " << data.m_type << ' ' << data.m_name
+           << ") { return ";
+        generateFnName(os, typeName, name);
+        os << '(';
+        for (const auto& param : args) {
+            if (param.m_tag != VarTag::Slave)
+                os << param.m_name << ", ";
         }
-        os << suffix;
-        os << "; }\n";
+        os << count.m_name << ", " << data.m_name;
+        if (policy)
+            os << ", dispatch";
+        os << "); }); }\n";
     }
 
-    void generateHandle(Output& os, TypeId typeId, GenState& state) {
+    void generateHandle(Output& os, TypeId typeId, GuardId guard,
+                        MethodPart part = MethodPart::Inline) const {
         const auto& typeInfo = m_typeInfos[typeId.getIndex()];
-        const auto support = findSupport(typeInfo.m_name);
-        if (!support)
-            return;
-        const auto guard = updateGuard(os, *support, state);
-        if (state.m_delim) {
-            os << '\n';
-            state.m_delim = false;
-        }
-        generateGuard(os, guard);
         os << "struct " << typeInfo.m_name << " : Handle<Vk" << typeInfo.m_name
            << ", ObjectType::e" << typeInfo.m_name << "> {";
         GenState stateMethod{.m_delim = true};
         for (const auto& cmd : findCommands(typeInfo.m_name)) {
-            generateCommand(os, cmd, typeInfo.m_name, state.m_guard,
-                            stateMethod);
+            generateCommand(os, cmd, typeInfo.m_name, guard, stateMethod,
+                            "vk", part);
         }
         updateGuard(os, {}, stateMethod);
         os << "};\n";
     }
 
     template<class Fn>
-    void processChildElems(const Element& elem, StrId tag, Fn fn) {
+    void processChildElems(const Element& elem, StrId tag, Fn fn) const {
         for (const auto child : m_ctx.getList(elem.children)) {
             if (child.getKind() == NodeKind::Element) {
                 const auto& elem = m_ctx.get(Idx<Element>{child.getIndex()});
@@ -1416,20 +3161,19 @@ struct Builder {
                 if (elem.tag == typesTag) {
                     processChildElems(
                         elem, typeTag, [this](const Element& elem) {
-                            if (const auto categoryAttr = findAttr(
+                            if (const auto category = findAttr(
                                     m_ctx.getList(elem.attrs), categoryTag)) {
-                                const auto category = m_ctx.get(categoryAttr);
-                                if (category == "struct") {
+                                if (isValue(category, structValue)) {
                                     processStructType(elem);
-                                } else if (category == "handle") {
+                                } else if (isValue(category, handleValue)) {
                                     processHandleType(elem);
-                                } else if (category == "basetype") {
+                                } else if (isValue(category, basetypeValue)) {
                                     processBaseType(elem);
-                                } else if (category == "union") {
+                                } else if (isValue(category, unionValue)) {
                                     processUnionType(elem);
-                                } else if (category == "enum") {
+                                } else if (isValue(category, enumValue)) {
                                     processEnumType(elem);
-                                } else if (category == "bitmask") {
+                                } else if (isValue(category, bitmaskValue)) {
                                     processBitmaskType(elem);
                                 }
                             }
@@ -1457,7 +3201,7 @@ struct Builder {
                         continue;
                     const auto guard = findAttr(attrs, nameTag);
                     if (const auto apitypeAttr = findAttr(attrs, apitypeTag)) {
-                        if (m_ctx.get(apitypeAttr) == "internal") {
+                        if (isValue(apitypeAttr, internalValue)) {
                             m_internalFeatureMap.insert(
                                 {m_ctx.get(guard), &elem});
                             continue;
@@ -1478,7 +3222,11 @@ struct Builder {
                                 if (findAttr(attrs, provisionalTag))
                                     return;
                                 const auto guard = findAttr(attrs, nameTag);
-                                processRequireList(elem, guard);
+                                std::string_view number;
+                                if (const auto numberAttr =
+                                        findAttr(attrs, numberTag))
+                                    number = m_ctx.get(numberAttr);
+                                processRequireList(elem, guard, number);
                             }
                         });
                 } else if (elem.tag == commandsTag) {
@@ -1535,9 +3283,10 @@ struct Builder {
         });
     }
 
-    void processRequireList(const Element& elem, StrId guard) {
+    void processRequireList(const Element& elem, StrId guard,
+                            std::string_view extNumber = {}) {
         m_scopes.insert(m_ctx.get(guard));
-        processChildElems(elem, requireTag, [this, guard](const Element& elem) {
+        processChildElems(elem, requireTag, [&](const Element& elem) {
             const auto attrs = m_ctx.getList(elem.attrs);
             if (!checkApi(attrs))
                 return;
@@ -1563,7 +3312,8 @@ struct Builder {
                             auto extends = m_ctx.get(extendsAttr);
                             if (consumeMatch(extends, "Vk")) {
                                 m_enumExtendsMap[extends].push_back(
-                                    {elem, GuardId{guard.value, false}});
+                                    {elem, GuardId{guard.value, false},
+                                     extNumber});
                             }
                         }
                     } else if (elem.tag == typeTag) {
@@ -1744,6 +3494,7 @@ struct Builder {
             if (const auto nameAttr = findAttr(attrs, nameTag)) {
                 const auto target = m_commandElemMap.find(m_ctx.get(aliasAttr));
                 if (target != m_commandElemMap.end()) {
+                    m_commandNames.push_back(m_ctx.get(nameAttr));
                     const auto& cmd = target->second;
                     if (cmd.m_type) {
                         auto type = m_ctx.get(cmd.m_type);
@@ -1778,6 +3529,7 @@ struct Builder {
         const auto name = getChildElemText(proto, nameTag);
         const auto typeTxt = getChildElemText(param, typeTag);
         m_commandElemMap.insert({m_ctx.get(name), {typeTxt, elem}});
+        m_commandNames.push_back(m_ctx.get(name));
         std::string_view objType;
         if (typeTxt) {
             auto type = m_ctx.get(typeTxt);
@@ -1810,18 +3562,115 @@ struct Builder {
     }
 };
 
+bool parseJobs(std::string_view arg, unsigned& jobs) {
+    if (arg == "--jobs") {
+        jobs = std::max(std::thread::hardware_concurrency(), 1u);
+        return true;
+    }
+    if (!arg.starts_with("--jobs="))
+        return false;
+    arg.remove_prefix(7);
+    const auto e = arg.data() + arg.size();
+    const auto [p, ec] = std::from_chars(arg.data(), e, jobs);
+    return ec == std::errc() && p == e && jobs != 0;
+}
+
 int main(int argc, const char* argv[]) {
-    if (argc != 3) {
-        print("Usage: {} <input.bin> <output.hpp>\n", argv[0]);
+    unsigned jobs = 1;
+    auto write = Output::Write::Always;
+    bool split = false;
+    bool dispatch = false;
+    bool dispatchPolicy = false;
+    bool enumerate = false;
+    bool spans = false;
+    bool unique = false;
+    bool chainLookup = false;
+    bool reflection = false;
+    bool toString = false;
+    bool parse = false;
+    bool trace = false;
+    const char* moduleFile = nullptr;
+    const char* checksFile = nullptr;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; ++argi) {
+        const std::string_view arg = argv[argi];
+        if (arg == "--if-changed")
+            write = Output::Write::IfChanged;
+        else if (arg == "--split")
+            split = true;
+        else if (arg == "--dispatch")
+            dispatch = true;
+        else if (arg == "--dispatch-policy")
+            dispatchPolicy = true;
+        else if (arg == "--enumerate")
+            enumerate = true;
+        else if (arg == "--spans")
+            spans = true;
+        else if (arg == "--unique")
+            unique = true;
+        else if (arg == "--chain-lookup")
+            chainLookup = true;
+        else if (arg == "--reflection")
+            reflection = true;
+        else if (arg == "--to-string")
+            toString = true;
+        else if (arg == "--parse")
+            parse = true;
+        else if (arg == "--trace")
+            trace = true;
+        else if (arg.starts_with("--module=") && arg.size() > 9)
+            moduleFile = argv[argi] + 9;
+        else if (arg.starts_with("--checks=") && arg.size() > 9)
+            checksFile = argv[argi] + 9;
+        else if (!parseJobs(arg, jobs))
+            break;
+    }
+    if (argc - argi != 2) {
+        print("Usage: {} [--jobs[=<count>]] [--if-changed] [--split] "
+              "[--dispatch] [--dispatch-policy] [--enumerate] [--spans] "
+              "[--unique] [--chain-lookup] [--reflection] [--to-string] "
+              "[--parse] [--trace] [--module=<output.cppm>] "
+              "[--checks=<output.cpp>] <input.bin> <output.hpp>\n",
+              argv[0]);
         return 1;
     }
+    const auto inputFile = argv[argi];
+    const auto outputFile = argv[argi + 1];
     try {
-        Input in{argv[1]};
-        const auto& ctx = *static_cast<const XmlContext*>(in.data());
+        Input in{inputFile, Input::Access::Random};
+        const auto& ctx = XmlContext::load(in.data(), in.size());
         Builder builder{ctx};
+        builder.m_dispatch = dispatch;
+        builder.m_dispatchPolicy = dispatchPolicy;
+        builder.m_enumerate = enumerate;
+        builder.m_spans = spans;
+        builder.m_unique = unique;
+        builder.m_chainLookup = chainLookup;
+        builder.m_reflection = reflection;
+        builder.m_toString = toString;
+        builder.m_parse = parse;
+        builder.m_trace = trace;
+        builder.m_module = moduleFile != nullptr;
         builder.process();
-        Output os{argv[2]};
-        builder.generate(os);
+        Output os{outputFile, write};
+        if (split) {
+            // Next to the output, named after it.
+            auto dir = std::filesystem::path(outputFile).replace_extension();
+            builder.generateSplit(os, dir, jobs, write);
+        } else {
+            builder.generate(os, jobs);
+        }
+        if (moduleFile) {
+            Output mod{moduleFile, write};
+            builder.generateModule(mod);
+            mod.close();
+        }
+        if (checksFile) {
+            Output checks{checksFile, write};
+            builder.generateChecks(checks);
+            checks.close();
+        }
+        os.close();
         return 0;
     } catch (const std::exception& e) {
         print(e.what());
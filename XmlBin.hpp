@@ -1,7 +1,19 @@
 #pragma once
 
+#include <array>
 #include <bit>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__) && (defined(__x86_64__) || defined(_M_X64))
+#include <nmmintrin.h>
+#define XMLBIN_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+#include <arm_acle.h>
+#define XMLBIN_CRC32C_ARM 1
+#endif
 
 namespace xmlbin {
     using ByteOffset = std::uint32_t;
@@ -31,11 +43,6 @@ namespace xmlbin {
         Size count = 0;
     };
 
-    struct UniqueStrEntry {
-        Index idx;
-        Index offset;
-    };
-
     constexpr std::uint32_t shiftL(std::uint32_t value, unsigned n) {
         assert(value < (1u << (32u - n)));
         return value << n;
@@ -75,7 +82,60 @@ namespace xmlbin {
         Sequence<NodeId> children;
     };
 
+    // "XBIN" in file byte order; reads back swapped on a foreign-endian host.
+    constexpr std::uint32_t kMagic = 0x4e494258u;
+    // Bump whenever the layout of any record below changes.
+    constexpr std::uint32_t kVersion = 2;
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        // Total file size in bytes.
+        Size size;
+        // CRC32C of everything following the header.
+        std::uint32_t checksum;
+        // Strings shorter than this are interned, so equal strings among them
+        // share a StrId and are all listed in the unique string table.
+        // 0 if the file was written without deduplication.
+        Size dedupLength;
+    };
+
+    namespace detail {
+        constexpr std::array<std::uint32_t, 256> makeCrc32cTable() {
+            std::array<std::uint32_t, 256> table{};
+            for (std::uint32_t i = 0; i != 256; ++i) {
+                auto c = i;
+                for (unsigned k = 0; k != 8; ++k)
+                    c = (c >> 1u) ^ (0x82f63b78u & (0u - (c & 1u)));
+                table[i] = c;
+            }
+            return table;
+        }
+
+        inline constexpr auto crc32cTable = makeCrc32cTable();
+    } // namespace detail
+
+    inline std::uint32_t crc32c(const void* data, std::size_t size) {
+        auto p = static_cast<const unsigned char*>(data);
+        std::uint32_t crc = ~0u;
+#if XMLBIN_CRC32C_X86 || XMLBIN_CRC32C_ARM
+        for (; size >= 8; size -= 8, p += 8) {
+            std::uint64_t v;
+            std::memcpy(&v, p, 8);
+#if XMLBIN_CRC32C_X86
+            crc = std::uint32_t(_mm_crc32_u64(crc, v));
+#else
+            crc = __crc32cd(crc, v);
+#endif
+        }
+#endif
+        for (; size; --size)
+            crc = detail::crc32cTable[(crc ^ *p++) & 0xffu] ^ (crc >> 8u);
+        return ~crc;
+    }
+
     struct Context {
+        Header header;
         Segment strings;
         Segment uniqueStrings;
         Segment nodes;
@@ -1,8 +1,11 @@
 #include <span>
 #include <vector>
+#include <charconv>
 #include <algorithm>
 #include <tinyxml2.h>
+#include <boost/unordered/unordered_flat_map.hpp>
 #include "XmlBin.hpp"
+#include "XmlReader.hpp"
 #include "Input.hpp"
 #include "Output.hpp"
 #include "Sort.hpp"
@@ -33,8 +36,10 @@ struct SegmentAlloc {
 };
 
 template<class T>
-void writeList(Output& os, const std::vector<T>& list) {
-    os.write(list.data(), sizeof(T) * list.size());
+void copyList(std::vector<char>& image, Segment seg,
+              const std::vector<T>& list) {
+    std::memcpy(image.data() + seg.offset, list.data(),
+                sizeof(T) * list.size());
 }
 
 template<class T>
@@ -43,56 +48,78 @@ std::span<T> getList(std::vector<T>& list, Sequence<T> seq) {
 }
 
 struct Builder {
-    std::vector<const char*> strings;
-    std::vector<UniqueStrEntry> uniqueStrings;
+    std::vector<std::string_view> strings;
+    // string -> offset into the string segment, can be kept sorted instead
+    // by defining XMLBIN_SORTED_INTERNER, as before it was a hash map, for
+    // comparing in vklite_bench_generators
+#ifdef XMLBIN_SORTED_INTERNER
+    std::vector<std::pair<std::string_view, Index>> uniqueStrings;
+#else
+    boost::unordered_flat_map<std::string_view, Index> uniqueStrings;
+#endif
     std::vector<NodeId> nodes;
     std::vector<Attribute> attrs;
     std::vector<Element> elems;
     Size stringSize = 1;
+    Size dedupLength = 0;
 
-    StrId getStr(std::string_view str) {
-        strings.push_back(str.data());
+    StrId addStr(std::string_view str) {
+        strings.push_back(str);
         const auto id = stringSize;
         stringSize += Size(str.size()) + 1;
         return {id};
     }
 
+    StrId getStr(std::string_view str) {
+        if (str.size() < dedupLength)
+            return getUniqueStr(str);
+        return addStr(str);
+    }
+
     StrId getUniqueStr(std::string_view str) {
-        const auto getStr = [this](UniqueStrEntry entry) {
-            return strings[entry.idx];
-        };
-        auto pos = std::ranges::lower_bound(uniqueStrings, str,
-                                            std::ranges::less{}, getStr);
-        if (pos == uniqueStrings.end() || str != getStr(*pos)) {
-            pos =
-                uniqueStrings.insert(pos, {Index(strings.size()), stringSize});
-            strings.push_back(str.data());
-            stringSize += Size(str.size()) + 1;
+#ifdef XMLBIN_SORTED_INTERNER
+        auto pos = std::ranges::lower_bound(
+            uniqueStrings, str, std::ranges::less{},
+            [](const auto& entry) { return entry.first; });
+        if (pos == uniqueStrings.end() || str != pos->first) {
+            pos = uniqueStrings.insert(pos, {str, stringSize});
+            addStr(str);
         }
-        return {pos->offset};
+        return {pos->second};
+#else
+        const auto [it, inserted] = uniqueStrings.try_emplace(str, stringSize);
+        if (inserted)
+            addStr(str);
+        return {it->second};
+#endif
     }
 
-    Attribute buildAttr(const tinyxml2::XMLAttribute& attr) {
+    Attribute buildAttr(std::string_view name, std::string_view value) {
         Attribute a;
-        a.name = getUniqueStr(attr.Name());
-        a.value = getStr(attr.Value());
+        a.name = getUniqueStr(name);
+        a.value = getStr(value);
         return a;
     }
 
+    Sequence<Attribute> addAttrs(std::vector<Attribute>& attrList) {
+        std::ranges::sort(attrList, std::ranges::less{},
+                          [](Attribute& a) { return a.name; });
+        Sequence<Attribute> seq{Index(attrs.size()), Size(attrList.size())};
+        attrs.resize(attrs.size() + attrList.size());
+        eytzinger(seq.count, [in = attrList.data(),
+                              out = attrs.data() + seq.start.value](
+                                 unsigned k) mutable { out[k] = *in++; });
+        return seq;
+    }
+
     void buildElem(const tinyxml2::XMLElement& elem) {
         Element e;
         e.tag = getUniqueStr(elem.Name());
         std::vector<Attribute> attrList;
         for (auto p = elem.FirstAttribute(); p; p = p->Next()) {
-            attrList.push_back(buildAttr(*p));
+            attrList.push_back(buildAttr(p->Name(), p->Value()));
         }
-        std::ranges::sort(attrList, std::ranges::less{},
-                          [](Attribute& a) { return a.name; });
-        e.attrs = {Index(attrs.size()), Size(attrList.size())};
-        attrs.resize(attrs.size() + attrList.size());
-        eytzinger(e.attrs.count, [in = attrList.data(),
-                                  out = attrs.data() + e.attrs.start.value](
-                                     unsigned k) mutable { out[k] = *in++; });
+        e.attrs = addAttrs(attrList);
 
         auto childIdx = Index(nodes.size());
         e.children.start = {childIdx};
@@ -112,48 +139,154 @@ struct Builder {
         }
     }
 
+    // XmlReader handler. Children lists are gathered per open element and
+    // appended to `nodes` when it closes; layoutChildren then moves them to
+    // where buildElem reserves them, so both paths write identical files.
+    struct OpenElem {
+        Index elem;
+        std::size_t firstChild;
+    };
+
+    std::vector<OpenElem> openElems;
+    std::vector<NodeId> openChildren;
+    std::vector<Attribute> attrScratch;
+
+    void beginElem(std::string_view tag, std::span<const XmlAttr> attrList) {
+        const auto elemIdx = Index(elems.size());
+        if (!openElems.empty())
+            openChildren.push_back(NodeId(NodeKind::Element, elemIdx));
+        Element e;
+        e.tag = getUniqueStr(tag);
+        attrScratch.clear();
+        for (const auto& attr : attrList) {
+            attrScratch.push_back(buildAttr(attr.name, attr.value));
+        }
+        e.attrs = addAttrs(attrScratch);
+        elems.push_back(e);
+        openElems.push_back({elemIdx, openChildren.size()});
+    }
+
+    void endElem() {
+        const auto open = openElems.back();
+        openElems.pop_back();
+        const auto first = openChildren.begin() + open.firstChild;
+        elems[open.elem].children = {
+            Index(nodes.size()), Size(openChildren.end() - first)};
+        nodes.insert(nodes.end(), first, openChildren.end());
+        openChildren.erase(first, openChildren.end());
+        if (openElems.empty())
+            layoutChildren();
+    }
+
+    void text(std::string_view str) {
+        openChildren.push_back(NodeId(NodeKind::Text, getStr(str).value));
+    }
+
+    // Comments and unknown markup count as children in tinyxml2, and
+    // buildElem leaves them as empty text nodes.
+    void other() { openChildren.push_back(NodeId()); }
+
+    // Elements are numbered in pre-order, and buildElem reserves the block
+    // of an element before any of its descendants do.
+    void layoutChildren() {
+        std::vector<NodeId> sorted(nodes.size());
+        Index next = 0;
+        for (auto& e : elems) {
+            std::copy_n(nodes.begin() + e.children.start.value,
+                        e.children.count, sorted.begin() + next);
+            e.children.start = {next};
+            next += e.children.count;
+        }
+        nodes.swap(sorted);
+    }
+
     void generate(Output& os) const {
-        std::vector<StrId> uniqueStrList(uniqueStrings.size() + 1);
-        eytzinger(Size(uniqueStrings.size()),
-                  [in = uniqueStrings.data(), out = uniqueStrList.data() + 1](
-                      unsigned k) mutable { out[k] = {(in++)->offset}; });
+        std::vector<std::pair<std::string_view, Index>> sortedStrs(
+            uniqueStrings.begin(), uniqueStrings.end());
+        std::ranges::sort(sortedStrs);
+        std::vector<StrId> uniqueStrList(sortedStrs.size() + 1);
+        eytzinger(Size(sortedStrs.size()),
+                  [in = sortedStrs.data(), out = uniqueStrList.data() + 1](
+                      unsigned k) mutable { out[k] = {(in++)->second}; });
         Context ctx;
-        {
-            SegmentAlloc a{sizeof(ctx)};
-            ctx.strings = a.alloc<char>(stringSize);
-            ctx.uniqueStrings = a.allocFor(uniqueStrList);
-            ctx.nodes = a.allocFor(nodes);
-            ctx.attrs = a.allocFor(attrs);
-            ctx.elems = a.allocFor(elems);
-        }
-        os.write(&ctx, sizeof(ctx));
-        os.seek(ctx.strings.offset);
-        os.write("", 1);
+        SegmentAlloc a{sizeof(ctx)};
+        ctx.strings = a.alloc<char>(stringSize);
+        ctx.uniqueStrings = a.allocFor(uniqueStrList);
+        ctx.nodes = a.allocFor(nodes);
+        ctx.attrs = a.allocFor(attrs);
+        ctx.elems = a.allocFor(elems);
+
+        std::vector<char> image(a.offset);
+        auto p = image.data() + ctx.strings.offset + 1;
         for (const std::string_view s : strings) {
-            os.write(s.data(), s.size() + 1);
+            std::memcpy(p, s.data(), s.size());
+            p += s.size() + 1;
         }
-        os.seek(ctx.uniqueStrings.offset);
-        writeList(os, uniqueStrList);
-        os.seek(ctx.nodes.offset);
-        writeList(os, nodes);
-        os.seek(ctx.attrs.offset);
-        writeList(os, attrs);
-        os.seek(ctx.elems.offset);
-        writeList(os, elems);
+        copyList(image, ctx.uniqueStrings, uniqueStrList);
+        copyList(image, ctx.nodes, nodes);
+        copyList(image, ctx.attrs, attrs);
+        copyList(image, ctx.elems, elems);
+        ctx.header = {kMagic, kVersion, Size(image.size()), 0, dedupLength};
+        std::memcpy(image.data(), &ctx, sizeof(ctx));
+        ctx.header.checksum = crc32c(image.data() + sizeof(Header),
+                                     image.size() - sizeof(Header));
+        std::memcpy(image.data(), &ctx.header, sizeof(Header));
+        os.write(image.data(), image.size());
     }
 };
 
+// --dedup[=<max-length>]
+bool parseDedup(std::string_view arg, Size& dedupLength) {
+    if (arg == "--dedup") {
+        dedupLength = ~Size(0);
+        return true;
+    }
+    if (!arg.starts_with("--dedup="))
+        return false;
+    arg.remove_prefix(8);
+    const auto e = arg.data() + arg.size();
+    Size maxLength;
+    const auto [p, ec] = std::from_chars(arg.data(), e, maxLength);
+    if (ec != std::errc() || p != e || maxLength == ~Size(0))
+        return false;
+    dedupLength = maxLength + 1;
+    return true;
+}
+
 int main(int argc, const char* argv[]) {
-    if (argc != 3) {
-        print("usage: {} <input.xml> <output.bin>\n", argv[0]);
+    Builder ctx;
+    bool stream = false;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; ++argi) {
+        const std::string_view arg = argv[argi];
+        if (arg == "--stream")
+            stream = true;
+        else if (!parseDedup(arg, ctx.dedupLength))
+            break;
+    }
+    if (argc - argi != 2) {
+        print("usage: {} [--stream] [--dedup[=<max-length>]] <input.xml> "
+              "<output.bin>\n",
+              argv[0]);
         return 1;
     }
+    const auto inputFile = argv[argi];
+    const auto outputFile = argv[argi + 1];
     try {
-        Input in{argv[1]};
+        Input in{inputFile};
+        if (stream) {
+            XmlReader reader{
+                {static_cast<const char*>(in.data()), in.size()}};
+            reader.read(ctx);
+            Output os{outputFile};
+            ctx.generate(os);
+            os.close();
+            return 0;
+        }
         tinyxml2::XMLDocument doc;
         if (doc.Parse(static_cast<const char*>(in.data()), in.size()) !=
             tinyxml2::XML_SUCCESS) {
-            print("failed to parse {}\n", argv[1]);
+            print("failed to parse {}\n", inputFile);
             return 1;
         }
         const auto root = doc.RootElement();
@@ -161,10 +294,10 @@ int main(int argc, const char* argv[]) {
             print("failed to retrieve root node.\n");
             return 1;
         }
-        Builder ctx;
         ctx.buildElem(*root);
-        Output os{argv[2]};
+        Output os{outputFile};
         ctx.generate(os);
+        os.close();
         return 0;
     } catch (const std::exception& e) {
         print(e.what());
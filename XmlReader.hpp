@@ -0,0 +1,291 @@
+#pragma once
+
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <vector>
+
+struct XmlAttr {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Single pass, SAX-style XML reader. It reports the same nodes tinyxml2
+// builds with its default settings: whitespace-only text is dropped,
+// entities and line breaks are normalized, and comments and unknown markup
+// inside elements are reported as opaque nodes.
+//
+// The handler is called with
+//   beginElem(std::string_view tag, std::span<const XmlAttr> attrs)
+//   endElem()
+//   text(std::string_view str)
+//   other()
+// All strings stay valid for the lifetime of the reader.
+struct XmlReader {
+    explicit XmlReader(std::string_view doc)
+        : m_begin(doc.data()), m_p(doc.data()),
+          m_end(doc.data() + doc.size()) {
+        consume("\xEF\xBB\xBF");
+    }
+
+    template<class Handler>
+    void read(Handler& handler) {
+        skipMisc();
+        if (m_p == m_end)
+            fail("no root element");
+        std::vector<std::string_view> open;
+        readStartTag(handler, open);
+        while (!open.empty()) {
+            const auto start = m_p;
+            skipSpace();
+            if (m_p == m_end)
+                fail("unexpected end of document");
+            if (*m_p != '<') {
+                m_p = start;
+                readText(handler);
+            } else if (consume("</")) {
+                const auto name = readName();
+                if (name != open.back())
+                    fail("mismatched end tag");
+                skipSpace();
+                expect('>');
+                open.pop_back();
+                handler.endElem();
+            } else if (consume("<!--")) {
+                skipPast("-->");
+                handler.other();
+            } else if (consume("<![CDATA[")) {
+                const auto b = m_p;
+                skipPast("]]>");
+                handler.text({b, std::size_t(m_p - b - 3)});
+            } else if (consume("<!")) {
+                skipPast(">");
+                handler.other();
+            } else if (startsWith("<?")) {
+                fail("declaration inside element");
+            } else {
+                readStartTag(handler, open);
+            }
+        }
+        skipMisc();
+        if (m_p != m_end)
+            fail("content after root element");
+    }
+
+private:
+    [[noreturn]] void fail(const char* reason) const {
+        std::size_t line = 1;
+        for (auto p = m_begin; p != m_p; ++p)
+            line += *p == '\n';
+        std::string msg("xml: ");
+        msg.append(reason).append(" at line ").append(std::to_string(line));
+        throw std::runtime_error(msg);
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+               c == '\f';
+    }
+
+    static bool isNameStart(char c) {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' ||
+               c == ':' || static_cast<unsigned char>(c) >= 0x80u;
+    }
+
+    static bool isName(char c) {
+        return isNameStart(c) || ('0' <= c && c <= '9') || c == '.' ||
+               c == '-';
+    }
+
+    bool startsWith(std::string_view str) const {
+        return std::string_view(m_p, m_end).starts_with(str);
+    }
+
+    bool consume(std::string_view str) {
+        if (!startsWith(str))
+            return false;
+        m_p += str.size();
+        return true;
+    }
+
+    void expect(char c) {
+        if (m_p == m_end || *m_p != c)
+            fail("malformed tag");
+        ++m_p;
+    }
+
+    void skipSpace() {
+        while (m_p != m_end && isSpace(*m_p))
+            ++m_p;
+    }
+
+    void skipPast(std::string_view str) {
+        const std::string_view rest(m_p, m_end);
+        const auto pos = rest.find(str);
+        if (pos == std::string_view::npos)
+            fail("unterminated markup");
+        m_p += pos + str.size();
+    }
+
+    // Whitespace, comments, declarations and DOCTYPE around the root.
+    void skipMisc() {
+        for (;;) {
+            skipSpace();
+            if (consume("<?"))
+                skipPast("?>");
+            else if (consume("<!--"))
+                skipPast("-->");
+            else if (consume("<!"))
+                skipPast(">");
+            else
+                break;
+        }
+    }
+
+    std::string_view readName() {
+        const auto b = m_p;
+        if (m_p == m_end || !isNameStart(*m_p))
+            fail("bad name");
+        while (++m_p != m_end && isName(*m_p)) {}
+        return {b, std::size_t(m_p - b)};
+    }
+
+    template<class Handler>
+    void readStartTag(Handler& handler, std::vector<std::string_view>& open) {
+        ++m_p; // '<'
+        const auto name = readName();
+        m_attrs.clear();
+        for (;;) {
+            skipSpace();
+            if (consume("/>")) {
+                handler.beginElem(name, std::span<const XmlAttr>(m_attrs));
+                handler.endElem();
+                return;
+            }
+            if (consume(">")) {
+                handler.beginElem(name, std::span<const XmlAttr>(m_attrs));
+                open.push_back(name);
+                return;
+            }
+            const auto attrName = readName();
+            skipSpace();
+            expect('=');
+            skipSpace();
+            if (m_p == m_end || (*m_p != '"' && *m_p != '\''))
+                fail("unquoted attribute value");
+            const char quote = *m_p++;
+            const auto b = m_p;
+            while (m_p != m_end && *m_p != quote)
+                ++m_p;
+            if (m_p == m_end)
+                fail("unterminated attribute value");
+            m_attrs.push_back(
+                {attrName, decode({b, std::size_t(m_p++ - b)})});
+        }
+    }
+
+    template<class Handler>
+    void readText(Handler& handler) {
+        const auto b = m_p;
+        while (m_p != m_end && *m_p != '<')
+            ++m_p;
+        if (m_p == m_end)
+            fail("unexpected end of document");
+        handler.text(decode({b, std::size_t(m_p - b)}));
+    }
+
+    static void appendUtf8(std::string& out, unsigned long c) {
+        if (c < 0x80u) {
+            out += char(c);
+        } else if (c < 0x800u) {
+            out += char(0xc0u | (c >> 6u));
+            out += char(0x80u | (c & 0x3fu));
+        } else if (c < 0x10000u) {
+            out += char(0xe0u | (c >> 12u));
+            out += char(0x80u | ((c >> 6u) & 0x3fu));
+            out += char(0x80u | (c & 0x3fu));
+        } else {
+            out += char(0xf0u | (c >> 18u));
+            out += char(0x80u | ((c >> 12u) & 0x3fu));
+            out += char(0x80u | ((c >> 6u) & 0x3fu));
+            out += char(0x80u | (c & 0x3fu));
+        }
+    }
+
+    // Decodes a character reference at `str` (just past "&#"), returns the
+    // number of characters consumed or 0 if it's malformed.
+    static std::size_t decodeCharRef(std::string_view str, std::string& out) {
+        const bool hex = str.starts_with('x');
+        const auto end = str.find(';');
+        if (end == std::string_view::npos || end == std::size_t(hex))
+            return 0;
+        unsigned long c = 0;
+        for (auto i = std::size_t(hex); i != end; ++i) {
+            const char d = str[i];
+            unsigned v;
+            if ('0' <= d && d <= '9')
+                v = d - '0';
+            else if (hex && 'a' <= (d | 0x20) && (d | 0x20) <= 'f')
+                v = (d | 0x20) - 'a' + 10;
+            else
+                return 0;
+            c = c * (hex ? 16u : 10u) + v;
+            if (c > 0x10ffffu)
+                return 0;
+        }
+        appendUtf8(out, c);
+        return end + 1;
+    }
+
+    std::string_view decode(std::string_view str) {
+        if (str.find_first_of("&\r") == std::string_view::npos)
+            return str;
+        static constexpr std::pair<std::string_view, char> entities[] = {
+            {"quot;", '"'}, {"amp;", '&'}, {"apos;", '\''},
+            {"lt;", '<'},   {"gt;", '>'},
+        };
+        auto& out = m_decoded.emplace_back();
+        out.reserve(str.size());
+        for (std::size_t i = 0; i != str.size();) {
+            const char c = str[i++];
+            if (c == '\r') {
+                out += '\n';
+                if (i != str.size() && str[i] == '\n')
+                    ++i;
+                continue;
+            }
+            if (c == '&') {
+                const auto rest = str.substr(i);
+                if (rest.starts_with('#')) {
+                    if (const auto n = decodeCharRef(rest.substr(1), out)) {
+                        i += n + 1;
+                        continue;
+                    }
+                } else {
+                    bool found = false;
+                    for (const auto& [name, value] : entities) {
+                        if (rest.starts_with(name)) {
+                            out += value;
+                            i += name.size();
+                            found = true;
+                            break;
+                        }
+                    }
+                    if (found)
+                        continue;
+                }
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    const char* m_begin;
+    const char* m_p;
+    const char* m_end;
+    std::vector<XmlAttr> m_attrs;
+    // Storage for strings that differ from their source text.
+    std::deque<std::string> m_decoded;
+};
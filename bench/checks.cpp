@@ -0,0 +1,31 @@
+#include <cstddef>
+#include <utility>
+#include <vulkan/vulkan.h>
+#include <vklite/vulkan.hpp>
+
+// Checked commands called from many places, each with its own failure path,
+// whose code size vklite_size_report compares.
+namespace {
+    template<std::size_t... I>
+    void createBuffers(vklite::Device device,
+                       const vklite::BufferCreateInfo& createInfo,
+                       vklite::Buffer* buffers, std::index_sequence<I...>) {
+        ((buffers[I] = device.createBuffer(createInfo).get()), ...);
+    }
+
+    template<std::size_t... I>
+    void resetFences(vklite::Device device, const vklite::Fence* fences,
+                     std::index_sequence<I...>) {
+        (vklite::check(device.resetFences(1, fences + I)), ...);
+    }
+} // namespace
+
+void createBuffers(vklite::Device device,
+                   const vklite::BufferCreateInfo& createInfo,
+                   vklite::Buffer (&buffers)[64]) {
+    createBuffers(device, createInfo, buffers, std::make_index_sequence<64>());
+}
+
+void resetFences(vklite::Device device, const vklite::Fence (&fences)[64]) {
+    resetFences(device, fences, std::make_index_sequence<64>());
+}
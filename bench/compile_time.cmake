@@ -0,0 +1,50 @@
+# Compiles sources with the commands CMake wrote for them to
+# compile_commands.json, and prints the fastest wall time of each:
+#   cmake -DCOMPILE_COMMANDS=<file> [-DRUNS=<count>] -P compile_time.cmake
+#       -- <source>...
+if(NOT DEFINED RUNS)
+	set(RUNS 5)
+endif()
+
+set(sources)
+set(found_sources FALSE)
+math(EXPR last_arg "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last_arg})
+	if(found_sources)
+		list(APPEND sources "${CMAKE_ARGV${i}}")
+	elseif("${CMAKE_ARGV${i}}" STREQUAL "--")
+		set(found_sources TRUE)
+	endif()
+endforeach()
+if(NOT COMPILE_COMMANDS OR NOT sources)
+	message(FATAL_ERROR "usage: cmake -DCOMPILE_COMMANDS=<file> [-DRUNS=<count>] -P compile_time.cmake -- <source>...")
+endif()
+
+file(READ "${COMPILE_COMMANDS}" commands)
+string(JSON count LENGTH "${commands}")
+math(EXPR last_command "${count} - 1")
+foreach(source IN LISTS sources)
+	file(TO_CMAKE_PATH "${source}" source)
+	set(found FALSE)
+	foreach(i RANGE ${last_command})
+		string(JSON file GET "${commands}" ${i} file)
+		file(TO_CMAKE_PATH "${file}" file)
+		if(file STREQUAL source)
+			string(JSON command GET "${commands}" ${i} command)
+			string(JSON directory GET "${commands}" ${i} directory)
+			set(found TRUE)
+			break()
+		endif()
+	endforeach()
+	if(NOT found)
+		message(FATAL_ERROR "no compile command for ${source}")
+	endif()
+	separate_arguments(command NATIVE_COMMAND "${command}")
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -DRUNS=${RUNS} -P "${CMAKE_CURRENT_LIST_DIR}/time.cmake" -- ${command}
+		WORKING_DIRECTORY "${directory}"
+		RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "timing ${source} failed: ${result}")
+	endif()
+endforeach()
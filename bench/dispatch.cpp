@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vulkan/vulkan.h>
+#include <vklite/vulkan.hpp>
+
+// Times a device command called through the loader and through the
+// DeviceDispatch table of the first physical device, needs vulkan.hpp
+// generated with dispatch tables:
+//   VkliteBenchDispatch
+template<class D>
+double timeGetQueue(const D& device) {
+    constexpr int callCount = 1 << 20;
+    constexpr int runCount = 5;
+    auto best = std::chrono::steady_clock::duration::max();
+    for (int run = 0; run != runCount; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i != callCount; ++i)
+            static_cast<void>(device.getQueue(0, 0));
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return std::chrono::duration<double, std::nano>(best).count() / callCount;
+}
+
+int main() {
+    VkApplicationInfo appInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instanceInfo{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+    instanceInfo.pApplicationInfo = &appInfo;
+    VkInstance instance = VK_NULL_HANDLE;
+    if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS) {
+        std::puts("skipped, no Vulkan instance");
+        return 0;
+    }
+    uint32_t count = 1;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    static_cast<void>(
+        vkEnumeratePhysicalDevices(instance, &count, &physicalDevice));
+    const float priority = 1;
+    VkDeviceQueueCreateInfo queueInfo{
+        VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+    queueInfo.queueFamilyIndex = 0;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+    VkDeviceCreateInfo deviceInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    VkDevice handle = VK_NULL_HANDLE;
+    if (!count || vkCreateDevice(physicalDevice, &deviceInfo, nullptr,
+                                 &handle) != VK_SUCCESS) {
+        std::puts("skipped, no Vulkan device");
+        vkDestroyInstance(instance, nullptr);
+        return 0;
+    }
+
+    vklite::DeviceDispatch dispatch;
+    dispatch.load(handle, vkGetDeviceProcAddr);
+    const vklite::Device device{{handle}};
+    const vklite::Dispatched<vklite::Device> dispatched{{{handle}}, &dispatch};
+    const auto loaderNs = timeGetQueue(device);
+    const auto tableNs = timeGetQueue(dispatched);
+    std::printf("getQueue, fastest of 5: %.2f ns through the loader, "
+                "%.2f ns through DeviceDispatch\n",
+                loaderNs, tableNs);
+
+    vkDestroyDevice(handle, nullptr);
+    vkDestroyInstance(instance, nullptr);
+    return 0;
+}
@@ -0,0 +1,10 @@
+import vklite;
+
+// Creates a buffer with the vklite module, which vklite_bench_module compiles
+// against include.cpp doing the same with vulkan.hpp.
+vklite::Buffer createUniformBuffer(vklite::Device device) {
+    vklite::BufferCreateInfo createInfo;
+    createInfo.setSize(65536);
+    createInfo.setUsage(vklite::BufferUsageFlagBits::bUniformBuffer);
+    return device.createBuffer(createInfo).get();
+}
@@ -0,0 +1,11 @@
+#include <vulkan/vulkan.h>
+#include <vklite/vulkan.hpp>
+
+// Creates a buffer with vulkan.hpp, which vklite_bench_module compiles
+// against import.cpp doing the same with the vklite module.
+vklite::Buffer createUniformBuffer(vklite::Device device) {
+    vklite::BufferCreateInfo createInfo;
+    createInfo.setSize(65536);
+    createInfo.setUsage(vklite::BufferUsageFlagBits::bUniformBuffer);
+    return device.createBuffer(createInfo).get();
+}
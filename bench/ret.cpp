@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <vklite/vulkan.hpp>
+
+// Times check() and Ret<T>::get() on results that succeed, the path every
+// checked command takes, build with and without exceptions to compare:
+//   VkliteBenchRet
+int main(int argc, char**) {
+    constexpr int callCount = 1 << 24;
+    constexpr int runCount = 5;
+    // Not known to the compiler, like the results of commands.
+    std::vector<vklite::Ret<uint64_t>> rets(1024);
+    for (std::size_t i = 0; i != rets.size(); ++i)
+        rets[i] = {vklite::Result(argc - 1), i};
+
+    const auto time = [&](auto fn) {
+        auto best = std::chrono::steady_clock::duration::max();
+        for (int run = 0; run != runCount; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::steady_clock::now() - start);
+        }
+        return std::chrono::duration<double, std::nano>(best).count() /
+               callCount;
+    };
+    uint64_t sum = 0;
+    const auto checkNs = time([&] {
+        for (int i = 0; i != callCount; ++i) {
+            const auto& ret = rets[i & 1023];
+            vklite::check(ret.result);
+            sum += ret.value;
+        }
+    });
+    const auto getNs = time([&] {
+        for (int i = 0; i != callCount; ++i)
+            sum += rets[i & 1023].get();
+    });
+    const auto valueOrNs = time([&] {
+        for (int i = 0; i != callCount; ++i)
+            sum += rets[i & 1023].value_or(0u);
+    });
+    std::printf("fastest of %d: %.3f ns check(), %.3f ns get(), %.3f ns "
+                "value_or() (%llu)\n",
+                runCount, checkNs, getNs, valueOrNs,
+                static_cast<unsigned long long>(sum));
+    return 0;
+}
@@ -0,0 +1,60 @@
+# Prints the code size of object files, split into the functions they
+# define, the inline functions they instantiate, the cold code in
+# .text.unlikely sections, and the unwind tables:
+#   cmake -DSIZE=<size> -P size_report.cmake -- <name> <object> ...
+set(args)
+set(found_args FALSE)
+math(EXPR last_arg "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last_arg})
+	if(found_args)
+		list(APPEND args "${CMAKE_ARGV${i}}")
+	elseif("${CMAKE_ARGV${i}}" STREQUAL "--")
+		set(found_args TRUE)
+	endif()
+endforeach()
+list(LENGTH args arg_count)
+math(EXPR odd "${arg_count} % 2")
+if(NOT DEFINED SIZE OR arg_count EQUAL 0 OR odd)
+	message(FATAL_ERROR "usage: cmake -DSIZE=<size> -P size_report.cmake -- <name> <object> ...")
+endif()
+
+message("     code   inline     cold   unwind")
+math(EXPR last_pair "${arg_count} - 2")
+foreach(i RANGE 0 ${last_pair} 2)
+	math(EXPR j "${i} + 1")
+	list(GET args ${i} name)
+	list(GET args ${j} object)
+	execute_process(COMMAND "${SIZE}" -A "${object}"
+		OUTPUT_VARIABLE sections RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${SIZE} -A ${object} failed: ${result}")
+	endif()
+	set(code 0)
+	set(inline 0)
+	set(cold 0)
+	set(unwind 0)
+	string(REPLACE "\n" ";" sections "${sections}")
+	foreach(line IN LISTS sections)
+		if(NOT line MATCHES "^(\\.[^ \t]+)[ \t]+([0-9]+)")
+			continue()
+		endif()
+		set(section "${CMAKE_MATCH_1}")
+		set(size "${CMAKE_MATCH_2}")
+		if(section MATCHES "^\\.text\\.unlikely")
+			math(EXPR cold "${cold} + ${size}")
+		elseif(section STREQUAL ".text")
+			math(EXPR code "${code} + ${size}")
+		elseif(section MATCHES "^\\.text\\.")
+			math(EXPR inline "${inline} + ${size}")
+		elseif(section MATCHES "^\\.(eh_frame|gcc_except_table)")
+			math(EXPR unwind "${unwind} + ${size}")
+		endif()
+	endforeach()
+	foreach(column code inline cold unwind)
+		string(LENGTH "${${column}}" length)
+		math(EXPR pad "9 - ${length}")
+		string(REPEAT " " ${pad} spaces)
+		set(${column} "${spaces}${${column}}")
+	endforeach()
+	message("${code}${inline}${cold}${unwind}  ${name}")
+endforeach()
\ No newline at end of file
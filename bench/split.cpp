@@ -0,0 +1,12 @@
+#include <vulkan/vulkan.h>
+#include <vklite/vulkan/VK_VERSION_1_0.hpp>
+
+// Creates a buffer with only the split header of VK_VERSION_1_0, which
+// vklite_bench_split compiles against include.cpp doing the same with all of
+// them.
+vklite::Buffer createUniformBuffer(vklite::Device device) {
+    vklite::BufferCreateInfo createInfo;
+    createInfo.setSize(65536);
+    createInfo.setUsage(vklite::BufferUsageFlagBits::bUniformBuffer);
+    return device.createBuffer(createInfo).get();
+}
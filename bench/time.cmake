@@ -0,0 +1,40 @@
+# Runs a command several times and prints its fastest wall time:
+#   cmake [-DRUNS=<count>] -P time.cmake -- <command> [<arg>...]
+if(NOT DEFINED RUNS)
+	set(RUNS 5)
+endif()
+
+set(command)
+set(found_command FALSE)
+math(EXPR last_arg "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last_arg})
+	if(found_command)
+		list(APPEND command "${CMAKE_ARGV${i}}")
+	elseif("${CMAKE_ARGV${i}}" STREQUAL "--")
+		set(found_command TRUE)
+	endif()
+endforeach()
+list(JOIN command " " command_str)
+if(NOT command)
+	message(FATAL_ERROR "usage: cmake [-DRUNS=<count>] -P time.cmake -- <command> [<arg>...]")
+endif()
+
+# microseconds since the epoch, which needs CMake 3.23
+set(best -1)
+foreach(run RANGE 1 ${RUNS})
+	string(TIMESTAMP start "%s%f")
+	execute_process(COMMAND ${command} RESULT_VARIABLE result OUTPUT_QUIET)
+	string(TIMESTAMP end "%s%f")
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "${command_str} failed: ${result}")
+	endif()
+	math(EXPR us "${end} - ${start}")
+	if(best LESS 0 OR us LESS best)
+		set(best ${us})
+	endif()
+endforeach()
+
+math(EXPR ms "${best} / 1000")
+math(EXPR us "${best} % 1000 + 1000")
+string(SUBSTRING "${us}" 1 3 us)
+message("${ms}.${us} ms, fastest of ${RUNS}: ${command_str}")
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef VKLITE_CHAIN_HPP
+#define VKLITE_CHAIN_HPP
+
+#include "vulkan.hpp"
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+VKLITE_EXPORT namespace vklite {
+    // Whether Ext may be chained to Head, i.e. it has an attach or
+    // attachHead member for it.
+    template<class Ext, class Head>
+    concept ExtensionOf =
+        requires(Head& head, Ext& ext) { head.attach(ext); } ||
+        requires(Head& head, Ext& ext) { head.attachHead(ext); };
+
+    template<class... T>
+    inline constexpr bool areDistinct = true;
+
+    template<class T, class... U>
+    inline constexpr bool areDistinct<T, U...> =
+        (!std::is_same_v<T, U> && ...) && areDistinct<U...>;
+
+    // Stores a struct and its extensions in one object, with their pNext
+    // linked in order. Copies are linked to their own structs.
+    //
+    //   StructChain<PhysicalDeviceFeatures2, PhysicalDeviceVulkan12Features>
+    //       features;
+    //   physicalDevice.getFeatures2(&features.get<PhysicalDeviceFeatures2>());
+    template<class Head, class... Exts>
+        requires(ExtensionOf<Exts, Head> && ...) && areDistinct<Head, Exts...>
+    struct StructChain {
+        StructChain() noexcept { link(); }
+
+        explicit StructChain(const Head& head, const Exts&... exts) noexcept
+            : m_structs(head, exts...) {
+            link();
+        }
+
+        StructChain(const StructChain& other) noexcept
+            : m_structs(other.m_structs) {
+            link();
+        }
+
+        StructChain& operator=(const StructChain& other) noexcept {
+            m_structs = other.m_structs;
+            link();
+            return *this;
+        }
+
+        template<class T>
+        T& get() noexcept {
+            return std::get<T>(m_structs);
+        }
+
+        template<class T>
+        const T& get() const noexcept {
+            return std::get<T>(m_structs);
+        }
+
+        operator Head&() noexcept { return std::get<Head>(m_structs); }
+
+        operator const Head&() const noexcept {
+            return std::get<Head>(m_structs);
+        }
+
+    private:
+        void link() noexcept {
+            link(std::make_index_sequence<sizeof...(Exts)>());
+        }
+
+        template<std::size_t... I>
+        void link(std::index_sequence<I...>) noexcept {
+            ((std::get<I>(m_structs).pNext = &std::get<I + 1>(m_structs)),
+             ...);
+            std::get<sizeof...(Exts)>(m_structs).pNext = nullptr;
+        }
+
+        std::tuple<Head, Exts...> m_structs;
+    };
+} // namespace vklite
+
+#endif // VKLITE_CHAIN_HPP
\ No newline at end of file
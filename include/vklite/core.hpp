@@ -2,12 +2,46 @@
 #define VKLITE_CORE_HPP
 
 #include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
 #include <span>
 #include <string_view>
 #include <type_traits>
 #include <system_error>
-
-namespace vklite {
+#include <utility>
+
+// Without exceptions, failures that check() and Ret<T>::get() find abort in
+// fail(), and Ret<T> is meant to be used like std::expected instead.
+#if !defined(VKLITE_NO_EXCEPTIONS) && !defined(__cpp_exceptions)
+#define VKLITE_NO_EXCEPTIONS
+#endif
+
+// For failure paths, which are kept out of the code of their callers. Can be
+// defined empty to compare, see vklite_size_report.
+#ifndef VKLITE_COLD
+#if defined(__GNUC__)
+#define VKLITE_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define VKLITE_COLD __declspec(noinline)
+#else
+#define VKLITE_COLD
+#endif
+#endif
+
+// Defined as export by the vklite module, which includes the vklite headers.
+#ifndef VKLITE_EXPORT
+#define VKLITE_EXPORT
+#endif
+
+// Defined by the vklite module to instantiate parse, see parse.hpp, for each
+// enum and flags type, as GCC 12 fails to instantiate std::optional of a
+// module's enum in code importing it.
+#ifndef VKLITE_INSTANTIATE_PARSE
+#define VKLITE_INSTANTIATE_PARSE(T)
+#endif
+
+VKLITE_EXPORT namespace vklite {
     struct ApiVersion {
         ApiVersion() = default;
 
@@ -45,6 +79,54 @@ namespace vklite {
         explicit operator bool() const noexcept { return !!handle; }
     };
 
+    // A handle calling its commands through a table of function pointers,
+    // specialized by vulkan.hpp when generated with dispatch tables.
+    template<class H>
+    struct Dispatched;
+
+    // The dispatcher handle methods call by default when vulkan.hpp is
+    // generated with dispatch policies, any type with the same members can
+    // be passed instead.
+    struct GlobalDispatch;
+
+    // How a handle is destroyed, specialized by vulkan.hpp when generated
+    // with unique handles:
+    //   using Parent = ...; // NoParent if it destroys itself
+    //   static void destroy(Parent parent, H handle) noexcept;
+    template<class H>
+    struct HandleTraits;
+
+    struct NoParent {};
+
+    // The sType of a struct, specialized by vulkan.hpp when generated with
+    // chain lookup.
+    template<class T>
+    inline constexpr VkStructureType structureTypeOf =
+        VK_STRUCTURE_TYPE_MAX_ENUM;
+
+    template<class T>
+    const T* findInChain(const void* chain) noexcept {
+        static_assert(structureTypeOf<T> != VK_STRUCTURE_TYPE_MAX_ENUM);
+        for (auto p = static_cast<const VkBaseInStructure*>(chain); p;
+             p = p->pNext) {
+            if (p->sType == structureTypeOf<T>)
+                return reinterpret_cast<const T*>(p);
+        }
+        return nullptr;
+    }
+
+    template<class T>
+    T* findInChain(void* chain) noexcept {
+        return const_cast<T*>(findInChain<T>(static_cast<const void*>(chain)));
+    }
+
+    // Calls visitor with s if it can be, see visitChain.
+    template<class Visitor, class T>
+    void visitStruct(Visitor& visitor, const T& s) {
+        if constexpr (std::is_invocable_v<Visitor&, const T&>)
+            visitor(s);
+    }
+
     struct Object {
         ObjectType type;
         uint64_t handle;
@@ -59,6 +141,8 @@ namespace vklite {
 
     template<class Enum, class Flags>
     struct FlagSet {
+        using Bits = Enum;
+
         FlagSet() = default;
 
         constexpr FlagSet(Enum val) : flags(static_cast<Flags>(val)) {}
@@ -102,18 +186,235 @@ namespace vklite {
         }
     };
 
+    // Not a local static, which GCC 12 doesn't emit for code importing the
+    // vklite module.
+    inline const ErrorCategory errorCategoryValue;
+
     inline const std::error_category& errorCategory() noexcept {
-        static const ErrorCategory ret;
-        return ret;
+        return errorCategoryValue;
     }
 
     inline std::error_condition make_error_condition(Result e) {
         return std::error_condition(int(e), errorCategory());
     }
 
-    inline void check(Result r) {
-        if (const int ec = int32_t(r); ec < 0)
-            throw std::system_error(ec, errorCategory());
+    // Where a function was called from, like std::source_location, whose
+    // header is heavier and which GCC 12 can't export from the vklite module.
+    struct SourceLocation {
+        static constexpr SourceLocation
+        current(const char* file = __builtin_FILE(),
+                uint32_t line = __builtin_LINE()) noexcept {
+            SourceLocation ret;
+            ret.m_file = file;
+            ret.m_line = line;
+            return ret;
+        }
+
+        constexpr const char* file_name() const noexcept { return m_file; }
+
+        constexpr uint32_t line() const noexcept { return m_line; }
+
+    private:
+        const char* m_file = "";
+        uint32_t m_line = 0;
+    };
+
+    // Reports a failed result out of line, so that its callers stay small.
+    // Throws std::system_error, which tells where it failed, or without
+    // exceptions calls VKLITE_FAILURE_HANDLER(r, loc) if it's defined and
+    // aborts.
+    [[noreturn]] VKLITE_COLD inline void fail(Result r,
+                                              SourceLocation loc) {
+#ifdef VKLITE_NO_EXCEPTIONS
+#ifdef VKLITE_FAILURE_HANDLER
+        VKLITE_FAILURE_HANDLER(r, loc);
+#endif
+        std::abort();
+#else
+        std::string what(loc.file_name());
+        what.append(":").append(std::to_string(loc.line()));
+        throw std::system_error(int32_t(r), errorCategory(), what);
+#endif
+    }
+
+    // The location is taken by value, a reference would make every caller
+    // store it even when it succeeds.
+    inline void
+    check(Result r,
+          SourceLocation loc = SourceLocation::current()) {
+        if (int32_t(r) < 0) [[unlikely]]
+            fail(r, loc);
+    }
+
+    // What the enumerate helpers of the commands take as `out`. Pointers don't
+    // qualify, so that calls passing the count pointer of the command itself
+    // never pick them.
+    template<class Container>
+    concept EnumerateOutput = requires(Container& out) {
+        out.data();
+        out.size();
+    };
+
+    // Runs a two-call enumeration `fn(uint32_t* pCount, T* pData)` into `out`,
+    // retrying while the result is incomplete. A resizable container, e.g.
+    // std::vector, std::pmr::vector or a small vector, keeps its capacity so
+    // that repeated calls don't allocate, and is tried first.
+    template<class Container, class Fn>
+    auto enumerate(Container& out, Fn fn) {
+        uint32_t count = 0;
+        if constexpr (std::is_void_v<decltype(fn(&count, nullptr))>) {
+            fn(&count, nullptr);
+            out.resize(count);
+            fn(&count, out.data());
+            out.resize(count);
+        } else {
+            Result r = Result(VK_INCOMPLETE);
+            if constexpr (requires { out.capacity(); }) {
+                out.resize(out.capacity());
+                count = uint32_t(out.size());
+                if (count)
+                    r = fn(&count, out.data());
+            }
+            while (r == Result(VK_INCOMPLETE)) {
+                r = fn(&count, nullptr);
+                if (int32_t(r) < 0)
+                    break;
+                out.resize(count);
+                r = fn(&count, out.data());
+            }
+            out.resize(int32_t(r) < 0 ? 0 : count);
+            return r;
+        }
+    }
+
+    // Fills a caller provided buffer and shrinks `out` to the part filled,
+    // the result is incomplete if it didn't fit.
+    template<class T, class Fn>
+    auto enumerate(std::span<T>& out, Fn fn) {
+        auto count = uint32_t(out.size());
+        if constexpr (std::is_void_v<decltype(fn(&count, out.data()))>) {
+            fn(&count, out.data());
+            out = out.first(count);
+        } else {
+            const Result r = fn(&count, out.data());
+            out = out.first(int32_t(r) < 0 ? 0 : count);
+            return r;
+        }
+    }
+
+    enum class MemberKind : uint8_t {
+        // Stored inline, e.g. a scalar, enum, flags or fixed array of them.
+        Value,
+        // Stored inline, only meaningful within the process.
+        Handle,
+        // A struct stored inline, or a fixed array of elementSize ones.
+        Struct,
+        // A pointer to the number of elements in the member at countIndex,
+        // or to at most one if that's -1. If count is set, it computes the
+        // number instead, e.g. from a size in bytes, and countIndex is the
+        // member it reads if any.
+        Array,
+        // A pointer to a null-terminated string.
+        String,
+        // The pNext chain.
+        Next,
+        // Any other pointer, e.g. user data.
+        Pointer,
+    };
+
+    // A member of a struct, for hashing, comparing and serializing structs
+    // without code for each one.
+    struct MemberInfo {
+        std::string_view name;
+        uint32_t offset;
+        uint32_t size;
+        MemberKind kind;
+        // The elements of a Struct or an Array.
+        MemberKind elementKind = MemberKind::Value;
+        uint32_t elementSize = 0;
+        int32_t countIndex = -1;
+        // The members of the elements if they're structs.
+        std::span<const MemberInfo> (*members)() noexcept = nullptr;
+        // The number of elements of an Array given by a formula, from the
+        // struct.
+        std::size_t (*count)(const void* s) noexcept = nullptr;
+    };
+
+    // The members of a struct, specialized by vulkan.hpp when generated with
+    // reflection:
+    //   static constexpr MemberInfo members[] = {...};
+    template<class T>
+    struct Reflection;
+
+    template<class T>
+    constexpr std::span<const MemberInfo> getMembers() noexcept {
+        return Reflection<T>::members;
+    }
+
+    // The names of the values of an enum, specialized by vulkan.hpp when
+    // generated with toString:
+    //   static constexpr char names[] = "A\0" "B\0";
+    //   static constexpr uint16_t offsets[] = {0, 2, 4, 5};
+    //   static constexpr int32_t first = 0;
+    // The names are in order of value, and the last one is empty for values
+    // without one. If the values aren't contiguous from first, they're in
+    // values[] instead.
+    template<class E>
+    struct EnumText;
+
+    // The name of a value without its prefix, e.g. "ErrorDeviceLost", or ""
+    // if it has none. The values are looked up by index if they're
+    // contiguous, otherwise by a binary search without branches.
+    template<class E>
+        requires requires { EnumText<E>::names; }
+    constexpr std::string_view toString(E value) noexcept {
+        using Text = EnumText<E>;
+        constexpr std::size_t count = std::size(Text::offsets) - 2;
+        const auto v = std::underlying_type_t<E>(value);
+        std::size_t i;
+        if constexpr (requires { Text::first; }) {
+            i = std::size_t(uint64_t(v) - uint64_t(Text::first));
+            i = i < count ? i : count;
+        } else {
+            auto p = Text::values;
+            for (auto n = count; n > 1; n -= n / 2)
+                p = p[n / 2] <= v ? p + n / 2 : p;
+            i = *p == v ? std::size_t(p - Text::values) : count;
+        }
+        const auto offset = Text::offsets[i];
+        return {Text::names + offset,
+                std::size_t(Text::offsets[i + 1] - offset - 1)};
+    }
+
+    // The names of the bits set, separated by " | ", followed by the bits
+    // without a name in hex.
+    template<class Enum, class Flags>
+    std::string toString(FlagSet<Enum, Flags> flags) {
+        std::string ret;
+        Flags unnamed = 0;
+        for (Flags bits = flags.flags; bits; bits &= bits - 1) {
+            const Flags bit = bits & (~bits + 1);
+            const auto name = toString(Enum(bit));
+            if (name.empty()) {
+                unnamed |= bit;
+                continue;
+            }
+            if (!ret.empty())
+                ret += " | ";
+            ret += name;
+        }
+        if (unnamed) {
+            if (!ret.empty())
+                ret += " | ";
+            char buf[2 + 2 * sizeof(Flags)];
+            auto p = std::end(buf);
+            for (; unnamed; unnamed >>= 4u)
+                *--p = "0123456789abcdef"[unnamed & 0xfu];
+            *--p = 'x';
+            *--p = '0';
+            ret.append(p, std::end(buf));
+        }
+        return ret;
     }
 
     template<class T>
@@ -121,13 +422,13 @@ namespace vklite {
         Result result;
         T value;
 
-        T get() const& {
-            check(result);
+        T get(SourceLocation loc = SourceLocation::current()) const& {
+            check(result, loc);
             return value;
         }
 
-        T get() && {
-            check(result);
+        T get(SourceLocation loc = SourceLocation::current()) && {
+            check(result, loc);
             return std::move(value);
         }
 
@@ -137,6 +438,103 @@ namespace vklite {
             out = std::move(value);
             return true;
         }
+
+        // Like std::expected, with the result as the error if it's negative.
+        constexpr bool has_value() const noexcept {
+            return int32_t(result) >= 0;
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return has_value();
+        }
+
+        constexpr Result error() const noexcept { return result; }
+
+        template<class U>
+        T value_or(U&& other) const& {
+            if (!has_value()) [[unlikely]]
+                return static_cast<T>(std::forward<U>(other));
+            return value;
+        }
+
+        template<class U>
+        T value_or(U&& other) && {
+            if (!has_value()) [[unlikely]]
+                return static_cast<T>(std::forward<U>(other));
+            return std::move(value);
+        }
+
+        // Returns fn(value), which is a Ret or a Result, if there's a value.
+        template<class Fn>
+        auto and_then(Fn&& fn) const& {
+            using R = std::remove_cvref_t<std::invoke_result_t<Fn, const T&>>;
+            if (!has_value()) [[unlikely]]
+                return failed<R>();
+            return std::forward<Fn>(fn)(value);
+        }
+
+        template<class Fn>
+        auto and_then(Fn&& fn) && {
+            using R = std::remove_cvref_t<std::invoke_result_t<Fn, T&&>>;
+            if (!has_value()) [[unlikely]]
+                return failed<R>();
+            return std::forward<Fn>(fn)(std::move(value));
+        }
+
+        // Returns fn(value) with the same result, if there's a value. If fn
+        // returns void, that's just the Result, like commands without a
+        // value return.
+        template<class Fn>
+        auto transform(Fn&& fn) const& {
+            using U = std::remove_cvref_t<std::invoke_result_t<Fn, const T&>>;
+            if constexpr (std::is_void_v<U>) {
+                if (has_value()) [[likely]]
+                    std::forward<Fn>(fn)(value);
+                return result;
+            } else {
+                if (!has_value()) [[unlikely]]
+                    return Ret<U>{result, {}};
+                return Ret<U>{result, std::forward<Fn>(fn)(value)};
+            }
+        }
+
+        template<class Fn>
+        auto transform(Fn&& fn) && {
+            using U = std::remove_cvref_t<std::invoke_result_t<Fn, T&&>>;
+            if constexpr (std::is_void_v<U>) {
+                if (has_value()) [[likely]]
+                    std::forward<Fn>(fn)(std::move(value));
+                return result;
+            } else {
+                if (!has_value()) [[unlikely]]
+                    return Ret<U>{result, {}};
+                return Ret<U>{result, std::forward<Fn>(fn)(std::move(value))};
+            }
+        }
+
+        // Returns fn(result), which is a Ret<T>, if there's an error.
+        template<class Fn>
+        Ret or_else(Fn&& fn) const& {
+            if (has_value()) [[likely]]
+                return *this;
+            return std::forward<Fn>(fn)(result);
+        }
+
+        template<class Fn>
+        Ret or_else(Fn&& fn) && {
+            if (has_value()) [[likely]]
+                return std::move(*this);
+            return std::forward<Fn>(fn)(result);
+        }
+
+    private:
+        template<class R>
+        R failed() const noexcept {
+            if constexpr (std::is_same_v<R, Result>)
+                return result;
+            else
+                return R{result, {}};
+        }
     };
 } // namespace vklite
 
@@ -0,0 +1,251 @@
+#ifndef VKLITE_DEFERRED_HPP
+#define VKLITE_DEFERRED_HPP
+
+#include "vulkan.hpp"
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+VKLITE_EXPORT namespace vklite {
+    // Destroys device handles once a timeline semaphore has reached the
+    // value they were queued with, instead of waiting for the device to be
+    // idle. push() may be called from any number of threads without locking,
+    // collect() and clear() from one thread at a time. The handles are
+    // destroyed through HandleTraits.
+    //
+    // The handles are queued in nodes from blocks of the given capacity,
+    // then twice as big as the last one, which collect() recycles, so that
+    // push() only allocates once they're all queued.
+    struct DeferredDestroyer {
+        DeferredDestroyer(Device device, Semaphore timeline,
+                          uint32_t capacity = 64)
+            : m_device(device), m_timeline(timeline), m_capacity(capacity) {
+            assert(capacity != 0);
+            const auto block = new Node[capacity];
+            m_blocks[0].store(block, std::memory_order_relaxed);
+            m_blockCount.store(1, std::memory_order_relaxed);
+            linkBlock(block, 0, capacity);
+            recycle(block, block + capacity - 1);
+        }
+
+        DeferredDestroyer(const DeferredDestroyer&) = delete;
+        DeferredDestroyer& operator=(const DeferredDestroyer&) = delete;
+
+        // Destroys everything left, the device must be done with it.
+        ~DeferredDestroyer() {
+            clear();
+            for (auto& block : m_blocks)
+                delete[] block.load(std::memory_order_relaxed);
+        }
+
+        // The handle is destroyed if there's no node left for it and
+        // another block can't be allocated.
+        template<class H>
+        void push(H handle, uint64_t value) {
+            static_assert(
+                std::is_same_v<typename HandleTraits<H>::Parent, Device>);
+            static_assert(sizeof(H) <= sizeof(Node::handle) &&
+                          std::is_trivially_copyable_v<H>);
+            auto node = allocate();
+            if (!node) [[unlikely]] {
+                HandleTraits<H>::destroy(m_device, handle);
+#ifndef VKLITE_NO_EXCEPTIONS
+                throw std::bad_alloc();
+#else
+                return;
+#endif
+            }
+            node->value = value;
+            node->destroy = &destroyNode<H>;
+            std::memcpy(node->handle, &handle, sizeof(H));
+            node->next = m_head.load(std::memory_order_relaxed);
+            while (!m_head.compare_exchange_weak(node->next, node,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {}
+        }
+
+        // Destroys everything queued with a value the timeline has reached.
+        Result collect() {
+            auto ret = m_device.getSemaphoreCounterValue(m_timeline);
+            uint64_t completed;
+            if (ret.extract(completed))
+                collect(completed);
+            return ret.result;
+        }
+
+        void collect(uint64_t completed) noexcept {
+            take();
+            Node* first = nullptr;
+            Node* last = nullptr;
+            Node** link = &m_pending;
+            while (const auto node = *link) {
+                if (node->value <= completed) {
+                    *link = node->next;
+                    node->destroy(m_device, *node);
+                    freeLater(node, first, last);
+                } else {
+                    link = &node->next;
+                }
+            }
+            if (first)
+                recycle(first, last);
+        }
+
+        void clear() noexcept {
+            take();
+            Node* first = nullptr;
+            Node* last = nullptr;
+            while (const auto node = m_pending) {
+                m_pending = node->next;
+                node->destroy(m_device, *node);
+                freeLater(node, first, last);
+            }
+            if (first)
+                recycle(first, last);
+        }
+
+    private:
+        struct Node {
+            Node* next;
+            // The index + 1 of the next free node, 0 for none.
+            std::atomic<uint32_t> nextFree;
+            uint32_t index;
+            uint64_t value;
+            void (*destroy)(Device device, const Node& node) noexcept;
+            alignas(uint64_t) unsigned char handle[sizeof(uint64_t)];
+        };
+
+        static_assert(std::atomic<Node*>::is_always_lock_free);
+        static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+        template<class H>
+        static void destroyNode(Device device, const Node& node) noexcept {
+            H handle;
+            std::memcpy(&handle, node.handle, sizeof(H));
+            HandleTraits<H>::destroy(device, handle);
+        }
+
+        // The first index of a block, the blocks being the capacity times
+        // 1, 2, 4...
+        uint64_t getFirstIndex(uint32_t block) const noexcept {
+            return uint64_t(m_capacity) * ((uint64_t(1) << block) - 1);
+        }
+
+        Node* getNode(uint32_t index) const noexcept {
+            const auto block =
+                uint32_t(std::bit_width(index / m_capacity + 1) - 1);
+            return m_blocks[block].load(std::memory_order_acquire) +
+                   (index - getFirstIndex(block));
+        }
+
+        void linkBlock(Node* block, uint32_t first, uint32_t size) noexcept {
+            for (uint32_t i = 0; i != size; ++i) {
+                block[i].index = first + i;
+                block[i].nextFree.store(first + i + 2,
+                                        std::memory_order_relaxed);
+            }
+        }
+
+        // Moves everything pushed so far onto the pending list, which only
+        // the collecting thread uses.
+        void take() noexcept {
+            auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+            while (node) {
+                const auto next = node->next;
+                node->next = m_pending;
+                m_pending = node;
+                node = next;
+            }
+        }
+
+        // Links a destroyed node before the others to recycle at once.
+        static void freeLater(Node* node, Node*& first, Node*& last) noexcept {
+            node->nextFree.store(first ? first->index + 1 : 0,
+                                 std::memory_order_relaxed);
+            first = node;
+            if (!last)
+                last = node;
+        }
+
+        // The free list is a stack of node indices, tagged with a count of
+        // its changes in the high half so that a pop racing with a pop and a
+        // push of the same node fails.
+        void recycle(Node* first, Node* last) noexcept {
+            auto head = m_free.load(std::memory_order_relaxed);
+            do {
+                last->nextFree.store(uint32_t(head),
+                                     std::memory_order_relaxed);
+            } while (!m_free.compare_exchange_weak(
+                head, nextTag(head) | (first->index + 1),
+                std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Node* pop() noexcept {
+            auto head = m_free.load(std::memory_order_acquire);
+            while (const auto index = uint32_t(head)) {
+                const auto node = getNode(index - 1);
+                const auto next =
+                    nextTag(head) |
+                    node->nextFree.load(std::memory_order_relaxed);
+                if (m_free.compare_exchange_weak(head, next,
+                                                 std::memory_order_acquire))
+                    return node;
+            }
+            return nullptr;
+        }
+
+        static uint64_t nextTag(uint64_t head) noexcept {
+            return ((head >> 32) + 1) << 32;
+        }
+
+        // Pops a free node, or adds a block and takes its first node if
+        // there's none, null if it can't be allocated.
+        Node* allocate() noexcept {
+            for (;;) {
+                if (const auto node = pop())
+                    return node;
+                const auto count =
+                    m_blockCount.load(std::memory_order_acquire);
+                if (count == maxBlocks)
+                    return nullptr;
+                // Another thread is adding this block.
+                if (m_blocks[count].load(std::memory_order_relaxed))
+                    continue;
+                const auto first = getFirstIndex(count);
+                const auto size = uint64_t(m_capacity) << count;
+                if (first + size > UINT32_MAX)
+                    return nullptr;
+                const auto block = new (std::nothrow) Node[size];
+                if (!block)
+                    return nullptr;
+                Node* expected = nullptr;
+                if (!m_blocks[count].compare_exchange_strong(
+                        expected, block, std::memory_order_release,
+                        std::memory_order_relaxed)) {
+                    delete[] block;
+                    continue;
+                }
+                m_blockCount.store(count + 1, std::memory_order_release);
+                linkBlock(block, uint32_t(first), uint32_t(size));
+                if (size > 1)
+                    recycle(block + 1, block + size - 1);
+                return block;
+            }
+        }
+
+        static constexpr uint32_t maxBlocks = 32;
+
+        Device m_device;
+        Semaphore m_timeline;
+        uint32_t m_capacity;
+        std::atomic<Node*> m_head = nullptr;
+        Node* m_pending = nullptr;
+        std::atomic<uint64_t> m_free = 0;
+        std::atomic<uint32_t> m_blockCount = 0;
+        std::atomic<Node*> m_blocks[maxBlocks] = {};
+    };
+} // namespace vklite
+
+#endif // VKLITE_DEFERRED_HPP
\ No newline at end of file
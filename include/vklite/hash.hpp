@@ -0,0 +1,299 @@
+#ifndef VKLITE_HASH_HPP
+#define VKLITE_HASH_HPP
+
+#include "vulkan.hpp"
+#include <cstring>
+
+VKLITE_EXPORT namespace vklite {
+    // Hashes a struct with everything it points to, following the Reflection
+    // of its members: arrays by their count, including bytes such as
+    // specialization data, strings by content and pNext chains by the sType
+    // of each struct in them. Other pointers, and structs in chains without
+    // a Reflection, are hashed by address. Meant to key caches of create
+    // infos, e.g.
+    //   std::unordered_map<SamplerCreateInfo, Sampler, DeepHash, DeepEqual>
+    // whose keys must own what they point to. Requires vulkan.hpp generated
+    // with reflection and chain lookup.
+    struct DeepHash {
+        template<class T>
+        std::size_t operator()(const T& s) const noexcept {
+            auto h = hashStruct(getMembers<T>(), &s, 0);
+            h = (h ^ (h >> 33u)) * 0xff51afd7ed558ccdu;
+            h = (h ^ (h >> 33u)) * 0xc4ceb9fe1a85ec53u;
+            return std::size_t(h ^ (h >> 33u));
+        }
+
+        // Hashes a word at a time, in four independent lanes for long runs
+        // so that the multiplications overlap.
+        static uint64_t hashBytes(const void* data, std::size_t size,
+                                  uint64_t h) noexcept {
+            auto p = static_cast<const unsigned char*>(data);
+            h = mix(h, size);
+            if (size >= 32) {
+                uint64_t lanes[4] = {h, ~h, h + k, h - k};
+                do {
+                    for (std::size_t i = 0; i != 4; ++i)
+                        lanes[i] = mix(lanes[i], load<uint64_t>(p + 8 * i));
+                    p += 32;
+                    size -= 32;
+                } while (size >= 32);
+                for (const auto lane : lanes)
+                    h = mix(h, lane);
+            }
+            for (; size >= 8; p += 8, size -= 8)
+                h = mix(h, load<uint64_t>(p));
+            if (size) {
+                uint64_t w = 0;
+                std::memcpy(&w, p, size);
+                h = mix(h, w);
+            }
+            return h;
+        }
+
+        static uint64_t hashStruct(std::span<const MemberInfo> members,
+                                   const void* s, uint64_t h) noexcept {
+            const auto base = static_cast<const char*>(s);
+            for (std::size_t i = 0; i != members.size();) {
+                const auto& member = members[i];
+                const auto p = base + member.offset;
+                if (isPlain(member.kind)) {
+                    const auto size = getRunSize(members, i);
+                    h = hashBytes(p, size, h);
+                    continue;
+                }
+                ++i;
+                switch (member.kind) {
+                case MemberKind::Struct:
+                    for (uint32_t j = 0; j != member.size;
+                         j += member.elementSize)
+                        h = hashStruct(member.members(), p + j, h);
+                    break;
+                case MemberKind::Array: {
+                    const auto data = load<const char*>(p);
+                    const auto count = getCount(members, member, base, data);
+                    h = mix(h, data ? count : ~uint64_t(0));
+                    h = hashArray(member, data, count, h);
+                    break;
+                }
+                case MemberKind::String:
+                    h = hashString(load<const char*>(p), h);
+                    break;
+                case MemberKind::Next:
+                    h = hashChain(load<const void*>(p), h);
+                    break;
+                default: break;
+                }
+            }
+            return h;
+        }
+
+    private:
+        static constexpr uint64_t k = 0x9e3779b97f4a7c15u;
+
+        static uint64_t mix(uint64_t h, uint64_t w) noexcept {
+            h = (h ^ w) * k;
+            return h ^ (h >> 32u);
+        }
+
+        static uint64_t hashArray(const MemberInfo& member, const char* data,
+                                  std::size_t count, uint64_t h) noexcept {
+            switch (member.elementKind) {
+            case MemberKind::Struct:
+                for (std::size_t i = 0; i != count; ++i) {
+                    h = hashStruct(member.members(),
+                                   data + i * member.elementSize, h);
+                }
+                return h;
+            case MemberKind::String:
+                for (std::size_t i = 0; i != count; ++i) {
+                    h = hashString(load<const char*>(
+                                       data + i * member.elementSize),
+                                   h);
+                }
+                return h;
+            default: return hashBytes(data, count * member.elementSize, h);
+            }
+        }
+
+        static uint64_t hashString(const char* str, uint64_t h) noexcept {
+            if (!str)
+                return mix(h, ~uint64_t(0));
+            return hashBytes(str, std::strlen(str), h);
+        }
+
+        static uint64_t hashChain(const void* chain, uint64_t h) noexcept {
+            const auto members = getChainMembers(chain);
+            if (members.empty())
+                return hashBytes(&chain, sizeof(chain), h);
+            return hashStruct(members, chain, h);
+        }
+
+        friend struct DeepEqual;
+
+        template<class T>
+        static T load(const void* p) noexcept {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            return value;
+        }
+
+        // Members stored inline and compared bytewise.
+        static bool isPlain(MemberKind kind) noexcept {
+            return kind == MemberKind::Value || kind == MemberKind::Handle ||
+                   kind == MemberKind::Pointer;
+        }
+
+        // The size of the plain members from i without padding between them,
+        // advancing i past them.
+        static uint32_t getRunSize(std::span<const MemberInfo> members,
+                                   std::size_t& i) noexcept {
+            const auto begin = members[i].offset;
+            auto end = begin + members[i].size;
+            while (++i != members.size() && isPlain(members[i].kind) &&
+                   members[i].offset == end)
+                end += members[i].size;
+            return end - begin;
+        }
+
+        // The number of elements of an Array member, 0 if it's null.
+        static std::size_t getCount(std::span<const MemberInfo> members,
+                                    const MemberInfo& member,
+                                    const char* base,
+                                    const void* data) noexcept {
+            if (!data)
+                return 0;
+            if (member.count)
+                return member.count(base);
+            if (member.countIndex < 0)
+                return 1;
+            const auto& count = members[member.countIndex];
+            if (count.size == sizeof(uint64_t))
+                return std::size_t(load<uint64_t>(base + count.offset));
+            return load<uint32_t>(base + count.offset);
+        }
+
+        static std::span<const MemberInfo>
+        getChainMembers(const void* chain) noexcept {
+            if (!chain)
+                return {};
+            return getMembers(
+                static_cast<const VkBaseInStructure*>(chain)->sType);
+        }
+    };
+
+    // Compares structs with everything they point to, like DeepHash hashes
+    // them.
+    struct DeepEqual {
+        template<class T>
+        bool operator()(const T& a, const T& b) const noexcept {
+            return equalStruct(getMembers<T>(), &a, &b);
+        }
+
+        static bool equalStruct(std::span<const MemberInfo> members,
+                                const void* a, const void* b) noexcept {
+            const auto baseA = static_cast<const char*>(a);
+            const auto baseB = static_cast<const char*>(b);
+            for (std::size_t i = 0; i != members.size();) {
+                const auto& member = members[i];
+                const auto pa = baseA + member.offset;
+                const auto pb = baseB + member.offset;
+                if (DeepHash::isPlain(member.kind)) {
+                    const auto size = DeepHash::getRunSize(members, i);
+                    if (std::memcmp(pa, pb, size) != 0)
+                        return false;
+                    continue;
+                }
+                ++i;
+                bool equal = true;
+                switch (member.kind) {
+                case MemberKind::Struct:
+                    for (uint32_t j = 0; equal && j != member.size;
+                         j += member.elementSize)
+                        equal = equalStruct(member.members(), pa + j, pb + j);
+                    break;
+                case MemberKind::Array: {
+                    const auto dataA = load<const char*>(pa);
+                    const auto dataB = load<const char*>(pb);
+                    const auto count =
+                        DeepHash::getCount(members, member, baseA, dataA);
+                    equal = !dataA == !dataB &&
+                            count == DeepHash::getCount(members, member, baseB,
+                                                        dataB) &&
+                            equalArray(member, dataA, dataB, count);
+                    break;
+                }
+                case MemberKind::String:
+                    equal = equalString(load<const char*>(pa),
+                                        load<const char*>(pb));
+                    break;
+                case MemberKind::Next:
+                    equal = equalChain(load<const void*>(pa),
+                                       load<const void*>(pb));
+                    break;
+                default: break;
+                }
+                if (!equal)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+        template<class T>
+        static T load(const void* p) noexcept {
+            return DeepHash::load<T>(p);
+        }
+
+        static bool equalArray(const MemberInfo& member, const char* a,
+                               const char* b, std::size_t count) noexcept {
+            if (a == b || count == 0)
+                return true;
+            switch (member.elementKind) {
+            case MemberKind::Struct:
+                for (std::size_t i = 0; i != count; ++i) {
+                    const auto offset = i * member.elementSize;
+                    if (!equalStruct(member.members(), a + offset, b + offset))
+                        return false;
+                }
+                return true;
+            case MemberKind::String:
+                for (std::size_t i = 0; i != count; ++i) {
+                    const auto offset = i * member.elementSize;
+                    if (!equalString(load<const char*>(a + offset),
+                                     load<const char*>(b + offset)))
+                        return false;
+                }
+                return true;
+            default:
+                return std::memcmp(a, b, count * member.elementSize) == 0;
+            }
+        }
+
+        static bool equalString(const char* a, const char* b) noexcept {
+            if (!a || !b)
+                return a == b;
+            return std::strcmp(a, b) == 0;
+        }
+
+        static bool equalChain(const void* a, const void* b) noexcept {
+            const auto members = DeepHash::getChainMembers(a);
+            if (members.empty() || a == b || !b ||
+                static_cast<const VkBaseInStructure*>(a)->sType !=
+                    static_cast<const VkBaseInStructure*>(b)->sType)
+                return a == b;
+            return equalStruct(members, a, b);
+        }
+    };
+
+    template<class T>
+    std::size_t hash(const T& s) noexcept {
+        return DeepHash()(s);
+    }
+
+    template<class T>
+    bool deepEqual(const T& a, const T& b) noexcept {
+        return DeepEqual()(a, b);
+    }
+} // namespace vklite
+
+#endif // VKLITE_HASH_HPP
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef VKLITE_PARSE_HPP
+#define VKLITE_PARSE_HPP
+
+// Included by vulkan.hpp when generated with parse, before the EnumText it
+// looks names up in, so that only code using it includes <optional>.
+#include "core.hpp"
+#include <optional>
+
+VKLITE_EXPORT namespace vklite {
+    // The FNV-1a hash of a name, seeded by EnumText<E>::hashSeed.
+    constexpr uint32_t hashName(std::string_view str, uint32_t seed) noexcept {
+        uint32_t h = 0x811c9dc5u ^ seed;
+        for (const char c : str)
+            h = (h ^ uint8_t(c)) * 0x01000193u;
+        return h;
+    }
+
+    // The value of a name, e.g. "ErrorDeviceLost", "eErrorDeviceLost" or
+    // "VK_ERROR_DEVICE_LOST", looked up by a perfect hash of the names when
+    // vulkan.hpp is generated with parse.
+    template<class E>
+        requires requires { EnumText<E>::keys; }
+    constexpr std::optional<E> parse(std::string_view str) noexcept {
+        using Text = EnumText<E>;
+        constexpr std::size_t count = std::size(Text::offsets) - 2;
+        if (str.size() > 1 && (str[0] == 'e' || str[0] == 'b') &&
+            !(str[1] >= 'a' && str[1] <= 'z'))
+            str.remove_prefix(1);
+        const auto key = hashName(str, Text::hashSeed);
+        const auto seed = Text::seeds[(key * 0x9e3779b1u) >> Text::bucketShift];
+        const auto slot = ((key ^ seed) * 0x85ebca6bu) >> Text::slotShift;
+        if (Text::keys[slot] != key)
+            return std::nullopt;
+        std::size_t i = Text::indices[slot];
+        std::string_view name;
+        if (i < count) {
+            name = {Text::names + Text::offsets[i],
+                    std::size_t(Text::offsets[i + 1] - Text::offsets[i] - 1)};
+        } else {
+            i -= count;
+            name = {Text::vkNames + Text::vkOffsets[i],
+                    std::size_t(Text::vkOffsets[i + 1] - Text::vkOffsets[i] -
+                                1)};
+        }
+        if (name != str)
+            return std::nullopt;
+        if constexpr (requires { Text::first; })
+            return E(Text::first + i);
+        else
+            return E(Text::values[i]);
+    }
+
+    // The flags of names separated by '|', which may also be numbers in hex
+    // as toString writes the bits without a name.
+    template<class F>
+        requires requires { EnumText<typename F::Bits>::keys; }
+    constexpr std::optional<F> parse(std::string_view str) noexcept {
+        using Flags = decltype(F::flags);
+        const auto trim = [](std::string_view s) {
+            while (!s.empty() && s.front() == ' ')
+                s.remove_prefix(1);
+            while (!s.empty() && s.back() == ' ')
+                s.remove_suffix(1);
+            return s;
+        };
+        F ret;
+        if (trim(str).empty())
+            return ret;
+        for (;;) {
+            const auto pos = str.find('|');
+            const auto name = trim(str.substr(0, pos));
+            if (name.starts_with("0x") && name.size() > 2) {
+                Flags bits = 0;
+                for (const char c : name.substr(2)) {
+                    const char l = char(c | 0x20);
+                    if (c >= '0' && c <= '9')
+                        bits = Flags(bits << 4u | Flags(c - '0'));
+                    else if (l >= 'a' && l <= 'f')
+                        bits = Flags(bits << 4u | Flags(l - 'a' + 10));
+                    else
+                        return std::nullopt;
+                }
+                ret.flags |= bits;
+            } else if (const auto bit = parse<typename F::Bits>(name)) {
+                ret.flags |= Flags(*bit);
+            } else {
+                return std::nullopt;
+            }
+            if (pos == std::string_view::npos)
+                return ret;
+            str.remove_prefix(pos + 1);
+        }
+    }
+} // namespace vklite
+
+#endif // VKLITE_PARSE_HPP
\ No newline at end of file
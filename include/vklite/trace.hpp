@@ -0,0 +1,238 @@
+#ifndef VKLITE_TRACE_HPP
+#define VKLITE_TRACE_HPP
+
+// Included by vulkan.hpp when generated with trace, after CommandId. Every
+// command starts with VKLITE_TRACE_CALL, which records its call count and
+// latency if VKLITE_TRACE is defined, and does nothing otherwise.
+#ifndef VKLITE_TRACE
+#define VKLITE_TRACE_CALL(id) static_cast<void>(0)
+#else
+#define VKLITE_TRACE_CALL(id)                                                 \
+    const ::vklite::TraceScope vkliteTraceScope(::vklite::CommandId::id)
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <new>
+#include <string>
+
+VKLITE_EXPORT namespace vklite {
+    // The calls of one thread, written only by it, so recording takes no
+    // locks or read-modify-write operations. It's kept after the thread
+    // exits so that its calls are still dumped, and taken over by the next
+    // thread that starts tracing, which adds to them under the same index.
+    struct TraceThread {
+        static constexpr std::size_t commandCount = std::size(commandNames);
+        // Latencies of [2^(i-1), 2^i) nanoseconds go into buckets[i].
+        static constexpr std::size_t bucketCount = 24;
+        // The last calls are kept for traceToChrome.
+        static constexpr std::size_t eventCount = 4096;
+
+        static_assert(commandCount <= 0xffff);
+
+        struct Stats {
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> totalNs;
+            std::atomic<uint64_t> buckets[bucketCount];
+        };
+
+        struct Event {
+            std::atomic<uint64_t> startNs;
+            // The duration above the CommandId in the low 16 bits.
+            std::atomic<uint64_t> durationAndId;
+        };
+
+        static uint64_t now() noexcept {
+            using namespace std::chrono;
+            const auto t = steady_clock::now().time_since_epoch();
+            return uint64_t(duration_cast<nanoseconds>(t).count());
+        }
+
+        // The one of this thread, taken over or allocated on its first call,
+        // null if that fails.
+        static TraceThread* get() noexcept {
+            thread_local Owner owner;
+            if (!owner.thread) [[unlikely]]
+                owner.thread = acquire();
+            return owner.thread;
+        }
+
+        // The first of all threads, newest first.
+        static TraceThread* getFirst() noexcept {
+            return head().load(std::memory_order_acquire);
+        }
+
+        void record(CommandId id, uint64_t start, uint64_t end) noexcept {
+            const auto i = std::size_t(id);
+            const auto ns = end - start;
+            auto& s = stats[i];
+            add(s.count, 1);
+            add(s.totalNs, ns);
+            add(s.buckets[std::min<std::size_t>(std::bit_width(ns),
+                                                bucketCount - 1)],
+                1);
+            const auto n = eventTotal.load(std::memory_order_relaxed);
+            auto& event = events[n % eventCount];
+            event.startNs.store(start, std::memory_order_relaxed);
+            event.durationAndId.store(ns << 16u | i, std::memory_order_relaxed);
+            eventTotal.store(n + 1, std::memory_order_release);
+        }
+
+        TraceThread* next = nullptr;
+        uint32_t index = 0;
+        std::atomic<bool> isFree;
+        std::atomic<uint64_t> eventTotal;
+        Stats stats[commandCount];
+        Event events[eventCount];
+
+    private:
+        static std::atomic<TraceThread*>& head() noexcept {
+            static std::atomic<TraceThread*> ret;
+            return ret;
+        }
+
+        // Frees the one of its thread when it exits.
+        struct Owner {
+            TraceThread* thread = nullptr;
+
+            ~Owner() {
+                if (thread)
+                    thread->isFree.store(true, std::memory_order_release);
+            }
+        };
+
+        static TraceThread* acquire() noexcept {
+            for (auto t = getFirst(); t; t = t->next) {
+                bool expected = true;
+                if (t->isFree.load(std::memory_order_relaxed) &&
+                    t->isFree.compare_exchange_strong(
+                        expected, false, std::memory_order_acquire,
+                        std::memory_order_relaxed))
+                    return t;
+            }
+            const auto thread = new (std::nothrow) TraceThread();
+            if (!thread)
+                return nullptr;
+            thread->next = head().load(std::memory_order_relaxed);
+            do {
+                thread->index = thread->next ? thread->next->index + 1 : 0;
+            } while (!head().compare_exchange_weak(thread->next, thread,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed));
+            return thread;
+        }
+
+        static void add(std::atomic<uint64_t>& a, uint64_t n) noexcept {
+            a.store(a.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+        }
+    };
+
+    // Records the latency of a command from its construction to its
+    // destruction.
+    struct TraceScope {
+        explicit TraceScope(CommandId id) noexcept
+            : m_thread(TraceThread::get()), m_id(id),
+              m_start(TraceThread::now()) {}
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+        ~TraceScope() {
+            if (m_thread)
+                m_thread->record(m_id, m_start, TraceThread::now());
+        }
+
+    private:
+        TraceThread* m_thread;
+        CommandId m_id;
+        uint64_t m_start;
+    };
+
+    // The calls of all threads so far, for the commands that were called:
+    //   {"commands": [
+    //     {"name": "vkQueueSubmit", "count": 2, "totalNs": 9000,
+    //      "histogram": [0, ..., 1, 1]}]}
+    // with the counts of the latency buckets of TraceThread in histogram.
+    inline std::string traceToJson() {
+        constexpr auto commandCount = TraceThread::commandCount;
+        constexpr auto bucketCount = TraceThread::bucketCount;
+        std::string ret("{\"commands\": [");
+        bool delim = false;
+        for (std::size_t i = 0; i != commandCount; ++i) {
+            uint64_t count = 0;
+            uint64_t totalNs = 0;
+            uint64_t buckets[bucketCount] = {};
+            for (auto t = TraceThread::getFirst(); t; t = t->next) {
+                const auto& s = t->stats[i];
+                count += s.count.load(std::memory_order_relaxed);
+                totalNs += s.totalNs.load(std::memory_order_relaxed);
+                for (std::size_t b = 0; b != bucketCount; ++b)
+                    buckets[b] += s.buckets[b].load(std::memory_order_relaxed);
+            }
+            if (!count)
+                continue;
+            ret += delim ? ",\n  " : "\n  ";
+            delim = true;
+            ret.append("{\"name\": \"")
+                .append(commandNames[i])
+                .append("\", \"count\": ")
+                .append(std::to_string(count))
+                .append(", \"totalNs\": ")
+                .append(std::to_string(totalNs))
+                .append(", \"histogram\": [");
+            for (std::size_t b = 0; b != bucketCount; ++b) {
+                if (b)
+                    ret += ", ";
+                ret += std::to_string(buckets[b]);
+            }
+            ret += "]}";
+        }
+        ret += "]}\n";
+        return ret;
+    }
+
+    // The last calls of all threads in the Chrome trace event format, for
+    // chrome://tracing or Perfetto. Calls recorded while it runs may come out
+    // mixed with the ones they replace.
+    inline std::string traceToChrome() {
+        const auto appendMicros = [](std::string& str, uint64_t ns) {
+            const auto frac = std::to_string(1000 + ns % 1000);
+            str.append(std::to_string(ns / 1000)).append(".").append(
+                frac, 1, 3);
+        };
+        std::string ret("{\"traceEvents\": [");
+        bool delim = false;
+        for (auto t = TraceThread::getFirst(); t; t = t->next) {
+            const auto total = t->eventTotal.load(std::memory_order_acquire);
+            const auto first =
+                total > TraceThread::eventCount
+                    ? total - TraceThread::eventCount
+                    : 0;
+            for (auto n = first; n != total; ++n) {
+                const auto& event = t->events[n % TraceThread::eventCount];
+                const auto startNs =
+                    event.startNs.load(std::memory_order_relaxed);
+                const auto durationAndId =
+                    event.durationAndId.load(std::memory_order_relaxed);
+                ret += delim ? ",\n  " : "\n  ";
+                delim = true;
+                ret.append("{\"name\": \"")
+                    .append(commandNames[durationAndId & 0xffffu])
+                    .append("\", \"ph\": \"X\", \"pid\": 0, \"tid\": ")
+                    .append(std::to_string(t->index))
+                    .append(", \"ts\": ");
+                appendMicros(ret, startNs);
+                ret += ", \"dur\": ";
+                appendMicros(ret, durationAndId >> 16u);
+                ret += '}';
+            }
+        }
+        ret += "]}\n";
+        return ret;
+    }
+} // namespace vklite
+#endif // VKLITE_TRACE
+
+#endif // VKLITE_TRACE_HPP
\ No newline at end of file
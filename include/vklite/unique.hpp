@@ -0,0 +1,127 @@
+#ifndef VKLITE_UNIQUE_HPP
+#define VKLITE_UNIQUE_HPP
+
+#include "vulkan.hpp"
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+VKLITE_EXPORT namespace vklite {
+    // Owns a handle and destroys it through its parent, which is all it
+    // stores, see HandleTraits.
+    template<class H>
+    struct Unique {
+        using Parent = typename HandleTraits<H>::Parent;
+
+        Unique() = default;
+
+        explicit Unique(H handle) noexcept
+            requires std::is_same_v<Parent, NoParent>
+            : m_handle(handle) {}
+
+        Unique(Parent parent, H handle) noexcept
+            : m_parent(parent), m_handle(handle) {}
+
+        Unique(Unique&& other) noexcept
+            : m_parent(other.m_parent), m_handle(other.release()) {}
+
+        Unique& operator=(Unique&& other) noexcept {
+            if (this != &other) {
+                reset();
+                m_parent = other.m_parent;
+                m_handle = other.release();
+            }
+            return *this;
+        }
+
+        ~Unique() { reset(); }
+
+        H get() const noexcept { return m_handle; }
+
+        Parent getParent() const noexcept { return m_parent; }
+
+        const H* operator->() const noexcept { return &m_handle; }
+
+        explicit operator bool() const noexcept { return !!m_handle; }
+
+        [[nodiscard]] H release() noexcept {
+            return std::exchange(m_handle, {});
+        }
+
+        void reset() noexcept {
+            if (m_handle)
+                HandleTraits<H>::destroy(m_parent, release());
+        }
+
+    private:
+        [[no_unique_address]] Parent m_parent = {};
+        H m_handle;
+    };
+
+    // Owns many handles of one parent and destroys them all at once, in
+    // reverse order of insertion, e.g. at shutdown.
+    template<class H>
+    struct UniqueList {
+        using Parent = typename HandleTraits<H>::Parent;
+
+        UniqueList() = default;
+
+        explicit UniqueList(Parent parent) noexcept : m_parent(parent) {}
+
+        UniqueList(UniqueList&& other) noexcept
+            : m_parent(other.m_parent),
+              m_handles(std::exchange(other.m_handles, {})) {}
+
+        UniqueList& operator=(UniqueList&& other) noexcept {
+            if (this != &other) {
+                clear();
+                m_parent = other.m_parent;
+                m_handles = std::exchange(other.m_handles, {});
+            }
+            return *this;
+        }
+
+        ~UniqueList() { clear(); }
+
+        // The handle is destroyed if it can't be added.
+        void push_back(H handle) {
+#ifdef VKLITE_NO_EXCEPTIONS
+            m_handles.push_back(handle);
+#else
+            try {
+                m_handles.push_back(handle);
+            } catch (...) {
+                HandleTraits<H>::destroy(m_parent, handle);
+                throw;
+            }
+#endif
+        }
+
+        void push_back(Unique<H>&& handle) {
+            if constexpr (!std::is_same_v<Parent, NoParent>)
+                assert(!handle || handle.getParent().handle == m_parent.handle);
+            if (handle)
+                push_back(handle.release());
+        }
+
+        void reserve(std::size_t n) { m_handles.reserve(n); }
+
+        std::size_t size() const noexcept { return m_handles.size(); }
+
+        bool empty() const noexcept { return m_handles.empty(); }
+
+        Parent getParent() const noexcept { return m_parent; }
+
+        void clear() noexcept {
+            for (auto it = m_handles.rbegin(); it != m_handles.rend(); ++it)
+                HandleTraits<H>::destroy(m_parent, *it);
+            m_handles.clear();
+        }
+
+    private:
+        [[no_unique_address]] Parent m_parent = {};
+        std::vector<H> m_handles;
+    };
+} // namespace vklite
+
+#endif // VKLITE_UNIQUE_HPP
\ No newline at end of file
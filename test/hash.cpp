@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <vulkan/vulkan.h>
+#include <vklite/hash.hpp>
+
+// Checks that DeepHash and DeepEqual follow what a GraphicsPipelineCreateInfo
+// points to, so that cache keys match by content rather than by address,
+// needs vulkan.hpp generated with reflection and chain lookup:
+//   VkliteTestHash
+
+namespace {
+    // A create info with everything it points to.
+    struct Pipeline {
+        uint32_t code[4] = {0x07230203, 0x10000, 0, 1};
+        uint32_t specData[2] = {16, 64};
+        char name[5] = "main";
+        vklite::SampleMask sampleMask[1] = {0xffffffffu};
+        vklite::SpecializationMapEntry mapEntries[2];
+        vklite::SpecializationInfo specialization;
+        vklite::ShaderModuleCreateInfo module;
+        vklite::PipelineShaderStageCreateInfo stages[1];
+        vklite::PipelineMultisampleStateCreateInfo multisample;
+        vklite::GraphicsPipelineCreateInfo createInfo;
+
+        Pipeline() {
+            for (uint32_t i = 0; i != 2; ++i) {
+                mapEntries[i].setConstantID(i);
+                mapEntries[i].setOffset(i * 4);
+                mapEntries[i].setSize(4);
+            }
+            specialization.setMapEntryCount(2);
+            specialization.setMapEntries(mapEntries);
+            specialization.setDataSize(sizeof(specData));
+            specialization.setData(specData);
+            module.setCodeSize(sizeof(code));
+            module.setCode(code);
+            stages[0].setName(name);
+            stages[0].setSpecializationInfo(&specialization);
+            stages[0].attach(module);
+            multisample.setRasterizationSamples(
+                vklite::SampleCountFlagBits::b1);
+            multisample.setSampleMask(sampleMask);
+            createInfo.setStageCount(1);
+            createInfo.setStages(stages);
+            createInfo.setMultisampleState(&multisample);
+        }
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+    };
+
+    int failures = 0;
+
+    void expect(bool value, const char* what) {
+        if (!value) {
+            std::fprintf(stderr, "failed: %s\n", what);
+            ++failures;
+        }
+    }
+
+    bool matches(const Pipeline& a, const Pipeline& b) {
+        return vklite::deepEqual(a.createInfo, b.createInfo);
+    }
+} // namespace
+
+int main() {
+    Pipeline a;
+    Pipeline b;
+    expect(vklite::hash(a.createInfo) == vklite::hash(b.createInfo),
+           "equal content at different addresses hashes equal");
+    expect(matches(a, b), "equal content at different addresses is equal");
+
+    // A caller reusing one buffer for the specialization data, shader code
+    // or sample mask must not match a key made before it changed.
+    const auto before = vklite::hash(a.createInfo);
+    a.specData[1] = 128;
+    expect(vklite::hash(a.createInfo) != before,
+           "changed specialization data changes the hash");
+    expect(!matches(a, b), "changed specialization data is not equal");
+    a.specData[1] = b.specData[1];
+    a.code[3] = 2;
+    expect(vklite::hash(a.createInfo) != before,
+           "changed shader code changes the hash");
+    expect(!matches(a, b), "changed shader code is not equal");
+    a.code[3] = b.code[3];
+    a.sampleMask[0] = 1;
+    expect(vklite::hash(a.createInfo) != before,
+           "changed sample mask changes the hash");
+    expect(!matches(a, b), "changed sample mask is not equal");
+    a.sampleMask[0] = b.sampleMask[0];
+    expect(vklite::hash(a.createInfo) == before && matches(a, b),
+           "restored content hashes and compares equal again");
+
+    // The empty slots of the chain lookup must not match any sType.
+    expect(vklite::structureTypeSlot(VK_STRUCTURE_TYPE_MAX_ENUM) ==
+               std::size(vklite::structureTypeKeys),
+           "VK_STRUCTURE_TYPE_MAX_ENUM is no struct's");
+    expect(vklite::getMembers(VK_STRUCTURE_TYPE_MAX_ENUM).empty(),
+           "VK_STRUCTURE_TYPE_MAX_ENUM has no members");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,16 @@
+#include <vulkan/vulkan.h>
+#ifdef VKLITE_TEST_SPLIT_CORE
+#include <vklite/vulkan/VK_VERSION_1_0.hpp>
+#else
+#include <vklite/vulkan.hpp>
+#endif
+
+// Checks that the split headers compile, through vulkan.hpp and with the
+// header of VK_VERSION_1_0 alone, which only needs what handles.hpp declares:
+//   cmake --build . --target VkliteTestSplit VkliteTestSplitCore
+vklite::Buffer createUniformBuffer(vklite::Device device) {
+    vklite::BufferCreateInfo createInfo;
+    createInfo.setSize(65536);
+    createInfo.setUsage(vklite::BufferUsageFlagBits::bUniformBuffer);
+    return device.createBuffer(createInfo).get();
+}